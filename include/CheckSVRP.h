@@ -0,0 +1,19 @@
+#ifndef CHECK_SVRP_H
+#define CHECK_SVRP_H
+
+/*
+checkExpectedLength: Compara, em rotas aleatórias pequenas, o custo esperado calculado
+pelas diferentes implementações: a versão original com a matriz f
+(routeExpectedLengthReference), a carga residual (routeExpectedLength), o avaliador
+incremental (RouteEvaluator), as enumerações exatas (bruteForce) e Monte Carlo. O erro
+da aproximação normal (approxRouteExpectedLength) nas rotas longas é apenas informado.
+
+Entrada:
+numTrials: número de rotas aleatórias;
+seed: semente das rotas e capacidades sorteadas.
+
+Saída: número de comparações fora da tolerância (0 se todas concordam).
+*/
+int checkExpectedLength(int numTrials, unsigned int seed);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef DEMAND_DISTRIBUTION_H
+#define DEMAND_DISTRIBUTION_H
+
+#include <vector>
+
+using namespace std;
+
+/*
+DemandDistribution: Distribuição da demanda de um vértice já combinada com a sua
+probabilidade de presença, montada uma vez por instância (ver Graph::computeDemandTables)
+e lida pelos avaliadores de rotas, pela busca tabu e pelo modelo L-shaped.
+
+- presence: probabilidade do vértice estar presente.
+- pmf[k]: probabilidade do vértice estar presente com demanda k.
+- cdf[k]: probabilidade da demanda ser no máximo k, dado que o vértice está presente.
+- tail[k]: probabilidade do vértice estar presente com demanda maior do que k.
+- mean, variance: média e variância da demanda, com demanda nula quando ausente.
+- minDemand, maxDemand: suporte das demandas com probabilidade positiva (0 e 0 se vazio).
+- uniform: se a demanda é uniforme em [minDemand, maxDemand].
+
+Os vetores têm limit + 1 posições, onde limit é a maior demanda da instância, e pmf e
+tail são nulos fora do suporte.
+*/
+struct DemandDistribution {
+
+    double presence = 1;
+    vector<double> pmf, cdf, tail;
+    double mean = 0, variance = 0;
+    int minDemand = 0, maxDemand = 0;
+    bool uniform = false;
+
+    /* Monta a distribuição a partir da probabilidade de presença e de "probDemand", a
+    distribuição da demanda dado que o vértice está presente, até a demanda "limit" */
+    void build(double presence, const vector<double>& probDemand, bool uniform, int limit);
+
+    // Menor demanda d com cdf[d] >= u, para u em [0, 1) (maxDemand se não houver)
+    int quantile(double u) const;
+
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef ELITE_POOL_H
+#define ELITE_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include "TabuSearchSVRP.h"
+
+/*
+ElitePool: Melhores soluções viáveis publicadas por buscas tabu que cooperam na mesma
+instância, número de veículos e capacidade (ver TabuSearchSVRP::elitePool).
+
+- elite: até "capacity" soluções em ordem crescente de custo, sem custos repetidos.
+- threshold: custo que uma solução precisa superar para entrar no pool (o da pior elite,
+com o pool cheio). É lido sem o mutex, então publicações que não entrariam no pool,
+a grande maioria, não disputam o mutex.
+- shareSolutions: se falso, o pool apenas registra as publicações (best nunca retorna
+uma solução), o que permite medir buscas isoladas da mesma forma que as cooperativas.
+- history: instantes (segundos desde a criação do pool) e custos de cada melhora da
+melhor solução do pool, usados para comparar estratégias ao longo do tempo.
+*/
+class ElitePool {
+
+public:
+
+    explicit ElitePool(int capacity = 4, bool shareSolutions = true);
+
+    // Insere uma cópia de "s" se ela for viável e melhor do que a pior elite
+    void publish(const svrpSol& s);
+
+    // Copia a melhor elite para "s", retornando falso se o pool estiver vazio
+    bool best(svrpSol& s) const;
+
+    vector<pair<double, double>> history() const;
+
+private:
+
+    int capacity;
+    bool shareSolutions;
+    vector<svrpSol> elite;
+    vector<pair<double, double>> improvements;
+    atomic<double> threshold;
+    chrono::steady_clock::time_point created;
+    mutable mutex lock;
+
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef EVAL_WORKSPACE_H
+#define EVAL_WORKSPACE_H
+
+#include "graph.h"
+#include "convolution.h"
+
+/*
+EvalWorkspace: Buffers de rascunho reaproveitados entre avaliações de rotas, evitando
+alocações durante a busca. Existe um por thread (ver localWorkspace) e é dimensionado
+para a instância no início da busca (reserve).
+
+- rows: linhas da distribuição da carga residual.
+- route: rota de rascunho.
+- probExceeds, probReach: probabilidades de falha de cada parada da rota de rascunho.
+- exceedCost, reachCost: custo de cada tipo de falha em cada parada (ver routeFailureCosts).
+- kernels: coeficientes da convolução de cada cliente da rota (ver routeExpectedLengthBothWays).
+- reverseExceeds, reverseReach: probabilidades de falha de cada parada com a rota percorrida
+no sentido inverso.
+- scratchFrom: posição a partir da qual a última avaliação escreveu em "rows" (ver
+RouteEvaluator::commitScratch).
+- evaluations: número de rotas avaliadas com este workspace.
+- allocations: número de vezes que algum buffer precisou ser realocado.
+
+O conteúdo dos buffers só é válido até a próxima avaliação que use o mesmo workspace.
+*/
+struct EvalWorkspace {
+
+    DemandRows rows;
+    vector<int> route;
+    vector<double> probExceeds, probReach;
+    vector<double> exceedCost, reachCost;
+    vector<DemandKernel> kernels;
+    vector<double> reverseExceeds, reverseReach;
+    int scratchFrom = 0;
+    long long evaluations = 0, allocations = 0;
+
+    // Dimensiona os buffers para rotas de até numberVertices - 1 clientes
+    void reserve(int numberVertices, int capacity, int padding);
+
+    // Garante ao menos "numRows" linhas de "length" colunas e "padding" posições antes de cada linha em "f", contando realocações
+    void fitRows(DemandRows& f, int numRows, int length, int padding);
+
+    // Redimensiona "v", contando realocações
+    template <class T>
+    void fit(vector<T>& v, size_t n) {
+        if (n > v.capacity())
+            this->allocations++;
+        v.resize(n);
+    }
+
+    // Copia "newRoute" para a rota de rascunho, contando realocações
+    void assignRoute(const vector<int>& newRoute);
+
+};
+
+// Workspace da thread atual
+EvalWorkspace& localWorkspace();
+
+/* Número de alocações feitas com operator new pela thread atual desde o seu início, ou -1
+em compilações com NDEBUG, nas quais as alocações não são contadas. Permite verificar que
+um trecho, como as iterações da busca tabu, não aloca memória. */
+long long threadAllocations();
+
+#endif
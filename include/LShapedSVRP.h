@@ -2,6 +2,6 @@
 #include "gurobi_c++.h"
 #include "SVRP.h"
 
-void solveSVRP(Graph g, int m, int Q, double L);
+void solveSVRP(const Graph& g, int m, int Q, double L);
 
 
@@ -0,0 +1,47 @@
+#ifndef MONTE_CARLO_SVRP_H
+#define MONTE_CARLO_SVRP_H
+
+#include <cstdint>
+#include "graph.h"
+
+/*
+MonteCarloOptions: parâmetros do estimador de Monte Carlo do custo esperado.
+- numThreads: número de threads (0 = número de núcleos disponíveis).
+- seed: semente dos geradores. Cada cenário usa números obtidos de um gerador baseado
+em contador (seed, índice do cenário, posição), então o resultado não depende do
+número de threads.
+- antithetic: avalia cada cenário junto ao seu antitético (u -> 1 - u).
+- controlVariate: usa o custo sem recurso do cenário, cuja esperança é conhecida,
+como variável de controle.
+- relativeHalfWidth: para quando a meia-largura do intervalo de confiança for no
+máximo relativeHalfWidth * |média|.
+- z: quantil normal do nível de confiança (1.96 = 95%).
+- minSamples, maxSamples: limites do número de cenários.
+- batchSize: cenários por lote; os lotes são a unidade de trabalho das threads, e cada
+rodada executa blocos de 16 * 1024 cenários, um por thread.
+*/
+struct MonteCarloOptions {
+    int numThreads = 0;
+    uint64_t seed = 1;
+    bool antithetic = false, controlVariate = false;
+    double relativeHalfWidth = 1e-3, z = 1.96;
+    long long minSamples = 1 << 14, maxSamples = 1 << 24;
+    int batchSize = 1024;
+};
+
+/*
+MonteCarloEstimate: resultado do estimador.
+- mean: custo esperado estimado; halfWidth: meia-largura do intervalo de confiança.
+- samples: cenários simulados (cada par antitético conta como dois).
+- beta: coeficiente da variável de controle (0 se não usada).
+*/
+struct MonteCarloEstimate {
+    double mean = 0, halfWidth = 0, beta = 0;
+    long long samples = 0;
+};
+
+MonteCarloEstimate monteCarloExpectedLength(const Graph& g, int capacity, const vector<vector<int>>& routes, const MonteCarloOptions& options = MonteCarloOptions());
+
+MonteCarloEstimate monteCarloRouteExpectedLength(const Graph& g, int capacity, const vector<int>& route, const MonteCarloOptions& options = MonteCarloOptions());
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef MULTI_START_SVRP_H
+#define MULTI_START_SVRP_H
+
+#include "SVRP.h"
+#include "ElitePool.h"
+
+/*
+MultiStartOptions: parâmetros das buscas tabu independentes.
+- numStarts: número de buscas.
+- numThreads: número de threads (0 = número de núcleos disponíveis).
+- masterSeed: semente da qual são sorteadas, em ordem, as sementes das buscas. O
+resultado depende apenas dela, e não do número de threads.
+- numFinalists, orientRoutes: como em TabuSearchSVRP, em todas as buscas.
+- candidateThreads: TabuSearchSVRP::numThreads de cada busca (0 = número de núcleos).
+Cada busca tem o seu pool, então até numThreads * candidateThreads threads trabalham
+ao mesmo tempo; o resultado não muda.
+- cooperative: se verdadeiro, as buscas compartilham um ElitePool com "eliteSize"
+soluções (ver TabuSearchSVRP::elitePool). O resultado deixa de depender só de
+masterSeed, pois depende do ritmo das threads.
+*/
+struct MultiStartOptions {
+    int numStarts = 8;
+    int numThreads = 0;
+    unsigned int masterSeed = 1;
+    int numFinalists = 0;
+    bool orientRoutes = false;
+    int candidateThreads = 1;
+    bool cooperative = false;
+    int eliteSize = 4;
+};
+
+/*
+MultiStartRun: estatísticas de uma das buscas.
+- seed: semente da busca (TabuSearchSVRP::seed).
+- expectedCost: custo da melhor solução viável (infinito se nenhuma foi encontrada).
+- iterations, evaluations: iterações e rotas avaliadas pela busca. As avaliações variam
+entre execuções, pois o cache de custos de rotas é compartilhado entre as buscas; os
+custos, não.
+- seconds: tempo decorrido da busca.
+*/
+struct MultiStartRun {
+    unsigned int seed = 0;
+    double expectedCost = 0.0;
+    int iterations = 0;
+    long long evaluations = 0;
+    double seconds = 0.0;
+};
+
+/*
+MultiStartResult: melhor solução viável entre as buscas (a de menor índice, em caso de
+empate; sem rotas se nenhuma busca encontrou solução viável), o índice da busca que a
+encontrou (-1 se nenhuma) e as estatísticas de cada busca, na ordem das sementes.
+"history" traz as melhoras do melhor custo publicado ao longo do tempo (ver
+ElitePool::history) e "seconds" o tempo decorrido do conjunto.
+*/
+struct MultiStartResult {
+    svrpSol best;
+    int bestStart = -1;
+    vector<MultiStartRun> runs;
+    vector<pair<double, double>> history;
+    double seconds = 0.0;
+};
+
+/*
+multiStartTabuSearch: Executa options.numStarts buscas tabu independentes na instância
+"g", compartilhada entre as threads apenas para leitura. Cada busca tem o seu próprio
+gerador, com a semente sorteada a partir de options.masterSeed; os vizinhos e demandas
+relativas (TabuSearchSVRP::prepare) são calculados uma vez e copiados para as buscas.
+
+Entrada:
+g: grafo do problema sendo considerado;
+numVehicles: número de veículos;
+capacity: capacidade dos veículos;
+options: parâmetros das buscas.
+
+Saída: a melhor solução e as estatísticas de cada busca.
+*/
+MultiStartResult multiStartTabuSearch(const Graph& g, int numVehicles, int capacity, const MultiStartOptions& options = MultiStartOptions());
+
+// Imprime as estatísticas de cada busca e a melhor solução
+void printMultiStart(const MultiStartResult& result);
+
+/*
+benchmarkCooperation: Compara, com as mesmas sementes e threads, buscas isoladas e
+cooperativas (options.cooperative), imprimindo o melhor custo de cada estratégia em
+frações do tempo total das buscas isoladas e o tempo para cada uma atingir o custo
+final das isoladas.
+*/
+void benchmarkCooperation(const Graph& g, int numVehicles, int capacity, const MultiStartOptions& options);
+
+#endif
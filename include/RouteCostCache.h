@@ -0,0 +1,82 @@
+#ifndef ROUTE_COST_CACHE_H
+#define ROUTE_COST_CACHE_H
+
+#include <cstdint>
+#include <mutex>
+#include "graph.h"
+
+/*
+RouteCostCacheStats: contadores de uso do cache de custos de rotas.
+- hits, misses: consultas que encontraram ou não o custo da rota.
+- insertions: custos inseridos.
+- evictions: custos descartados para dar lugar a novos (política CLOCK).
+*/
+struct RouteCostCacheStats {
+    long long hits = 0, misses = 0, insertions = 0, evictions = 0;
+};
+
+/*
+RouteCostCache: Cache limitado do custo esperado de rotas, indexado pelo conteúdo da
+rota, pela capacidade e pela instância (Graph::instanceId).
+
+O cache é dividido em "numShards" partes, cada uma protegida por um mutex e com
+slotsPerShard posições, de forma que threads diferentes raramente disputam a mesma
+parte. Em cada parte, uma tabela de endereçamento aberto aponta para as posições, e a
+posição descartada quando a parte está cheia é escolhida pela política CLOCK: cada
+consulta bem-sucedida marca a posição, e o ponteiro do relógio desmarca posições até
+encontrar uma não marcada. Os clientes das rotas ficam num bloco de cada parte, com
+maxRouteLength inteiros por posição, alocado no construtor: consultas e inserções não
+alocam memória. Rotas com mais de maxRouteLength clientes não são guardadas.
+
+Com numShards = 0 o cache fica desativado (nenhuma consulta encontra custo).
+*/
+class RouteCostCache {
+
+public:
+
+    RouteCostCache(int numShards = 16, int slotsPerShard = 4096, int maxRouteLength = 64);
+
+    // Procura o custo de "route"; retorna verdadeiro e preenche "cost" se encontrado
+    bool find(const Graph& g, int capacity, const vector<int>& route, double& cost);
+
+    // Insere (ou atualiza) o custo de "route"
+    void insert(const Graph& g, int capacity, const vector<int>& route, double cost);
+
+    void clear();
+
+    RouteCostCacheStats stats() const;
+
+    bool enabled() const { return this->numShards > 0; }
+
+private:
+
+    struct Slot {
+        uint64_t hash = 0;
+        int instanceId = 0, capacity = 0, length = 0;
+        double cost = 0;
+        bool referenced = false;
+    };
+
+    struct Shard {
+        mutable mutex lock;
+        vector<Slot> slots;
+        vector<int> clients; // clientes da rota de cada posição, maxRouteLength por posição
+        vector<int> table; // índices em "slots", -1 se vazio
+        int hand = 0, numUsed = 0;
+        RouteCostCacheStats stats;
+    };
+
+    int numShards, maxRouteLength;
+    vector<Shard> shards;
+
+    static uint64_t hashRoute(int instanceId, int capacity, const vector<int>& route);
+    int findSlot(const Shard& shard, uint64_t hash, int instanceId, int capacity, const vector<int>& route) const;
+    static void eraseFromTable(Shard& shard, int slot);
+    static void insertInTable(Shard& shard, int slot);
+
+};
+
+// Cache compartilhado por todas as avaliações do programa
+RouteCostCache& routeCostCache();
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef ROUTE_EVALUATOR_H
+#define ROUTE_EVALUATOR_H
+
+#include "graph.h"
+#include "convolution.h"
+#include "EvalWorkspace.h"
+#include "RouteCostCache.h"
+
+/*
+RouteEvaluator: Avaliador incremental do custo esperado de uma rota.
+
+Mantém a distribuição da carga residual (ver advanceResidualLoad) para todos os
+prefixos da rota, junto com as probabilidades de falha (exceder ou atingir exatamente
+a capacidade) em cada parada. Como a linha m depende apenas dos m primeiros clientes,
+inserir ou remover um cliente na posição k só exige recalcular as linhas de k em diante,
+e as probabilidades de falha das paradas a partir de k (o sufixo da rota).
+
+- f: f.row(m)[r] = probabilidade da demanda total dos clientes 1, ..., m ser congruente a r
+módulo capacity. Cada linha possui "capacity" colunas, em um buffer contíguo.
+
+- probExceeds, probReach: probabilidade de exceder/atingir a capacidade na parada i,
+somada sobre todos os possíveis números de falhas.
+
+- cost: custo esperado da rota atual.
+
+As funções "costWith*" avaliam a rota modificada sem alterar o estado cacheado,
+utilizando apenas os buffers de rascunho do workspace "ws" (por padrão, o da thread),
+e consultam o cache compartilhado de custos de rotas (routeCostCache). Por isso, threads
+diferentes podem chamá-las ao mesmo tempo no mesmo avaliador.
+As modificações avaliam a nova rota no workspace e trocam os buffers com ele.
+*/
+class RouteEvaluator {
+
+public:
+
+    RouteEvaluator();
+
+    // Avalia "route" reaproveitando o maior prefixo em comum com a rota atual
+    void assign(const Graph* g, int capacity, const vector<int>& route, EvalWorkspace& ws = localWorkspace());
+
+    // Modificações da rota cacheada
+    void append(int client, EvalWorkspace& ws = localWorkspace());
+    void insert(int pos, int client, EvalWorkspace& ws = localWorkspace());
+    void remove(int pos, EvalWorkspace& ws = localWorkspace());
+
+    // Custos de rotas modificadas, sem alterar a rota cacheada
+    double costWithInsert(int pos, int client, EvalWorkspace& ws = localWorkspace()) const;
+    double costWithRemove(int pos, EvalWorkspace& ws = localWorkspace()) const;
+    double costWithRoute(const vector<int>& newRoute, EvalWorkspace& ws = localWorkspace()) const;
+    // Custo com o cliente da posição "from" levado para a posição "to" da rota sem ele
+    double costWithMove(int from, int to, EvalWorkspace& ws = localWorkspace()) const;
+
+    /* Como costWithRoute, mas interrompe a avaliação assim que um limitante inferior do
+    custo atinge "limit", retornando esse limitante (>= limit) com "complete" falso */
+    double boundedCostWithRoute(const vector<int>& newRoute, double limit, bool& complete, EvalWorkspace& ws = localWorkspace()) const;
+    double boundedCostWithInsert(int pos, int client, double limit, bool& complete, EvalWorkspace& ws = localWorkspace()) const;
+    double boundedCostWithMove(int from, int to, double limit, bool& complete, EvalWorkspace& ws = localWorkspace()) const;
+
+    double expectedLength() const { return this->cost; }
+    const vector<int>& getRoute() const { return this->route; }
+    int size() const { return this->route.size(); }
+
+private:
+
+    const Graph* g;
+    int capacity;
+    double cost;
+    vector<int> route;
+    DemandRows f;
+    vector<double> probExceeds, probReach;
+
+    int commonPrefix(const vector<int>& a, const vector<int>& b) const;
+    double evaluateFrom(int k, EvalWorkspace& ws, double limit, bool& complete) const;
+    double evaluate(int k, EvalWorkspace& ws, bool useCache, double limit, bool& complete) const;
+    double evaluate(int k, EvalWorkspace& ws, bool useCache) const;
+    void scratchInsert(int pos, int client, EvalWorkspace& ws) const;
+    void scratchRemove(int pos, EvalWorkspace& ws) const;
+    void scratchMove(int from, int to, EvalWorkspace& ws) const;
+    void commitScratch(double newCost, EvalWorkspace& ws);
+
+};
+#endif
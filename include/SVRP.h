@@ -1,26 +1,77 @@
+#ifndef SVRP_H
+#define SVRP_H
+
 #include "TabuSearchSVRP.h"
+#include "convolution.h"
+#include "EvalWorkspace.h"
+#include "RouteCostCache.h"
 #include<numeric>
 
-vector<vector<double>> probTotalDemand(Graph g, vector<int> route);
+/*
+FailureProfile: probabilidades de falha de cada parada de uma rota, por número de falhas.
+- exceeds[i][q], reach[i][q]: probabilidade da q-ésima falha ocorrer na parada i por
+exceder ou por atingir exatamente a capacidade, para 1 <= q <= maxFailures.
+- totalExceeds[i], totalReach[i]: somas sobre q.
+- loadExceeds[q]: probabilidade da demanda total da rota ser maior do que q*capacity.
+*/
+struct FailureProfile {
+    int capacity = 0, maxFailures = 0;
+    vector<vector<double>> exceeds, reach;
+    vector<double> totalExceeds, totalReach, loadExceeds;
+
+    double probLoadExceeds(int q) const;
+};
+
+vector<vector<double>> probTotalDemand(const Graph& g, const vector<int>& route);
+
+void probTotalDemand(const Graph& g, const vector<int>& route, DemandRows& f);
+
+void failureProfile(const Graph& g, const vector<vector<double>>& f, int capacity, const vector<int>& route, FailureProfile& profile);
+
+void failureProfile(const Graph& g, const DemandRows& f, int capacity, const vector<int>& route, FailureProfile& profile);
+
+double restockLowerBound(const Graph& g, const FailureProfile& profile, int numVehicles, const vector<int>& depotNeighbours);
+
+double probReachCapacity(int i, const Graph& g, const vector<vector<double>>& f, int capacity, const vector<int>& route);
+
+double probExceedsCapacity(int i, const Graph& g, const vector<vector<double>>& f, int capacity, const vector<int>& route);
 
-double probReachCapacity(int i, Graph g, vector<vector<double>> f, int capacity, vector<int> route);
+double probExceedsCapacity(int i, const Graph& g, const vector<vector<double>>& f, int capacity, const vector<int>& route, int j);
 
-double probExceedsCapacity(int i, Graph g, vector<vector<double>> f, int capacity, vector<int> route);
+void advanceResidualLoad(const Graph& g, int capacity, const double* row, int client, double* next);
 
-double probExceedsCapacity(int i, Graph g, vector<vector<double>> f, int capacity, vector<int> route, int j);
+void residualFailureProbabilities(const Graph& g, int capacity, const double* row, int client, double& probExceeds, double& probReach);
 
-double returnCost (int i, int j, Graph g, vector<int> orderInRoute);
+double returnCost(int i, int j, const Graph& g, const vector<int>& orderInRoute);
 
-double routeExpectedLength(Graph g, vector<vector<double>> f, int capacity, vector<int> route);
+double routeExpectedLengthReference(const Graph& g, const vector<vector<double>>& f, int capacity, const vector<int>& route);
 
-double totalExpectedLength(Graph g, int capacity, vector<vector<int>> routes);
+double routeExpectedLength(const Graph& g, const vector<vector<double>>& f, int capacity, const vector<int>& route);
+
+double routeExpectedLength(const Graph& g, const vector<int>& route, const vector<double>& probExceeds, const vector<double>& probReach);
+
+double routeFailureCosts(const Graph& g, const vector<int>& route, vector<double>& exceedCost, vector<double>& reachCost);
+
+double routeExpectedLength(const Graph& g, int capacity, const vector<int>& route, EvalWorkspace& ws = localWorkspace());
+
+double routeExpectedLengthBothWays(const Graph& g, int capacity, const vector<int>& route, double& reverseCost, EvalWorkspace& ws = localWorkspace());
+
+double approxRouteExpectedLength(const Graph& g, int capacity, const vector<int>& route, EvalWorkspace& ws = localWorkspace());
+
+double totalExpectedLength(const Graph& g, int capacity, const vector<vector<int>>& routes, EvalWorkspace& ws = localWorkspace());
 
 vector<vector<int>> randomRoutes(int numberVertices, int numberVehicles);
 
-double costCen(vector<vector<int>> A, vector<int> B, Graph g, vector<int> route, int capacity);
+double realizedRouteCost(const Graph& g, const vector<int>& route, const vector<int>& demands, int capacity);
+
+double costCen(const vector<vector<int>>& A, const vector<int>& B, const Graph& g, const vector<int>& route, int capacity);
+
+double presentRouteExpectedCost(const Graph& g, int capacity, const vector<int>& route);
+
+double bruteForce(const Graph& g, int capacity, const vector<vector<int>>& routes, bool enumerateDemands = true, int numThreads = 0);
 
-double bruteForce(Graph g, int capacity, vector<vector<int>> route);
+double bruteForceCost(const Graph& g, int capacity, const vector<int>& route);
 
-double bruteForceCost(Graph g, int capacity, vector<int> route);
+void drawRoutes(Graph g, const svrpSol& solution, const string& nameOutputFile);
 
-void drawRoutes(Graph g, svrpSol solution, string nameOutputFile);
+#endif
@@ -0,0 +1,63 @@
+#ifndef SWEEP_SVRP_H
+#define SWEEP_SVRP_H
+
+#include "SVRP.h"
+
+/*
+SweepResult: Resultado da busca tabu para um ponto de uma varredura.
+- numVehicles, capacity: frota e capacidade usadas (capacidade ao menos Graph::demandLimit).
+- expectedLoad: demanda esperada total sobre a capacidade da frota (numVehicles * capacity).
+- solution: melhor solução viável encontrada (sem rotas se nenhuma foi encontrada).
+- lowerBound: limitante L do custo de recurso (ver restockLowerBound).
+- seconds, iterations: tempo de processamento e iterações da busca.
+*/
+struct SweepResult {
+    int numVehicles = 0, capacity = 0;
+    double expectedLoad = 0.0;
+    svrpSol solution;
+    double lowerBound = 0.0;
+    double seconds = 0.0;
+    int iterations = 0;
+};
+
+/*
+capacitySweep: Resolve a instância "g" com "numVehicles" veículos para cada capacidade
+de "capacities", em um único processo. O que não depende da capacidade é calculado uma
+única vez: a distribuição da demanda total de todos os clientes (probTotalDemand), da
+qual sai o perfil de falhas de cada capacidade, e os vizinhos mais próximos e as
+demandas relativas da busca tabu (TabuSearchSVRP::prepare).
+
+As distribuições de cada rota não são compartilhadas entre as capacidades: as linhas
+da carga residual são tomadas módulo a capacidade, e o cache de custos de rotas é
+separado por capacidade, então cada busca avalia suas rotas do zero.
+
+Entrada:
+g: grafo do problema sendo considerado;
+numVehicles: número de veículos;
+capacities: capacidades a resolver, elevadas a g.demandLimit se menores.
+
+Saída: um resultado por capacidade, na ordem de "capacities".
+*/
+vector<SweepResult> capacitySweep(const Graph& g, int numVehicles, const vector<int>& capacities);
+
+/*
+fleetSweep: Resolve a instância "g" com capacidade "capacity" para cada número de
+veículos de maxVehicles até minVehicles, em ordem decrescente. Cada busca parte da melhor
+solução da anterior, que tem uma rota a mais e só precisa ser consolidada; como os
+movimentos nunca criam rotas, a ordem crescente não aproveitaria a solução anterior.
+Vizinhos, demandas relativas, perfil de falhas e o cache de custos de rotas (mesma
+instância e capacidade) são compartilhados entre as buscas.
+
+Entrada:
+g: grafo do problema sendo considerado;
+capacity: capacidade dos veículos, elevada a g.demandLimit se menor;
+minVehicles, maxVehicles: intervalo de números de veículos, limitado a [1, número de clientes].
+
+Saída: um resultado por número de veículos, em ordem crescente.
+*/
+vector<SweepResult> fleetSweep(const Graph& g, int capacity, int minVehicles, int maxVehicles);
+
+// Imprime o relatório de uma varredura, uma linha por resultado
+void printSweep(const Graph& g, const vector<SweepResult>& results);
+
+#endif
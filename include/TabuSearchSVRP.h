@@ -1,6 +1,15 @@
+#ifndef TABU_SEARCH_SVRP_H
+#define TABU_SEARCH_SVRP_H
+
 #include "kmeans.h"
+#include "RouteEvaluator.h"
+#include "WorkerPool.h"
+#include <memory>
 
 #define MAX_ITERATIONS 10000
+#define ELITE_PERIOD 100
+
+class ElitePool;
 
 /*
 Lista de definições e especificações:
@@ -9,12 +18,21 @@ Lista de definições e especificações:
 soluções vizinhas. O movimento é levar "client" para a posição anterior à
 "neighbour". "it" possui o número da iteração na qual esse movimento foi
 realizado, utilizado para manter os movimentos tabu. Um routeMove é considerado
-igual à outro se "client" e "neighbour" forem iguais.
+igual à outro se "client" e "clientRoute" (rota de onde o cliente saiu) forem iguais.
 
 - svrpSol: Estrutura que indica uma solução do svrp com rotas "routes" e custo
-total "expectedCost".
+total "expectedCost" (penalizado, na busca). "routeCosts" guarda o custo esperado de
+cada rota, "routesCost" a soma deles e "routeVersions" uma versão de cada rota,
+renovada sempre que ela é alterada. Versões são únicas durante a busca (routeStamp),
+então rotas com a mesma versão são iguais, mesmo entre cópias da solução.
+
+- routeChange: Movimento descrito por posições, sem cópias das rotas: "client", na
+posição "from" da rota r1, é levado para a posição "to" da rota r2 ou, se r2 < 0, da
+própria rota r1 sem ele. cost1 e cost2 são os custos esperados das rotas r1 e r2 após o
+movimento. O custo de um movimento é calculado apenas pela diferença nessas rotas, com
+as rotas novas montadas apenas nos buffers de rascunho dos avaliadores.
 
-- g: Grafo do problema.
+- g: Grafo do problema, compartilhado com quem chamou run (não é copiado).
 
 - penalty: penalidade para soluções inviáveis (numRoutes > numVehicles).
 
@@ -48,10 +66,78 @@ igual a "m^v" do paper.
 - moveDone: melhor movimento não-tabu selecionado na lista de candidatos
 bestMoves (= variável L do paper) que gera a solução sol (="y" ou "z" do paper).
 
+- searchEvaluations, searchAllocations: número de rotas avaliadas e de alocações de
+memória (threadAllocations) durante as iterações da busca, incluindo as feitas pelas
+outras threads do pool (poolEvaluations, poolAllocations), cujos workspaces são
+próprios; taskEvaluations e taskAllocations guardam as de cada candidato de
+evaluateCandidates. As iterações usam apenas buffers dimensionados em initialize; as
+únicas alocações são a da cópia da primeira solução viável de cada busca, que dimensiona
+as rotas de bestFeasibleSol (vazias até então, indicando que nenhuma foi encontrada), e
+as das cópias guardadas por elitePool. Em compilações com NDEBUG as alocações não são
+contadas e searchAllocations é -1.
+
+- bestMoves, candidates, selected, candidateCosts, finalistOrder, finalist: buffers de
+neighbourhoodSearch reaproveitados entre iterações (lista de movimentos candidatos,
+candidatos avaliados exatamente, seus índices e custos e a ordem e marcação dos
+finalistas da triagem).
+
+- screenedMove: Candidato da triagem, com o custo penalizado aproximado.
+
+- numFinalists: se positivo, os candidatos de cada iteração são ordenados pela
+aproximação normal do custo (approxRouteExpectedLength) e apenas os numFinalists
+melhores, e os numFinalists melhores não tabu, são avaliados exatamente. Se 0, todos
+os candidatos são avaliados exatamente.
+
+- screenedCandidates, exactCandidates: candidatos triados e avaliados exatamente.
+maxScreeningError e sumScreeningError: maior e soma dos erros relativos da aproximação
+nos candidatos avaliados exatamente.
+
+- lowerBounds: se verdadeiro, a avaliação exata de um candidato é interrompida assim
+que um limitante inferior do seu custo mostra que ele não supera o melhor candidato até
+o momento (ver evaluateBounded). Como esses candidatos nunca seriam escolhidos, a busca
+não muda.
+
+- boundedCandidates, skippedEvaluations: candidatos avaliados com limitante e
+avaliações exatas interrompidas por ele.
+
+- orientRoutes: se verdadeiro, toda rota alterada por um movimento é invertida quando o
+sentido inverso tem custo esperado menor (ver orientRoute). Desligado por padrão, pois
+muda a trajetória da busca e custa cerca de 1,7 avaliação por rota alterada; requer
+distâncias simétricas (Graph::symmetricDistances). reversedRoutes: número de rotas
+invertidas.
+
+- numThreads: threads que avaliam exatamente os candidatos de cada iteração (0 = número
+de núcleos). Com mais de uma, os candidatos são avaliados juntos no pool persistente
+"pool" e reduzidos na ordem, sem os limitantes de lowerBounds, que dependem do melhor
+candidato anterior; o movimento escolhido é o mesmo da busca sequencial. Os sorteios
+(generator) continuam na thread da busca, e a saída detalhada (verbosity) é impressa por ela
+depois das avaliações, na ordem dos candidatos.
+
+- seed, generator: semente e gerador dos sorteios da busca (clientes e vizinhos dos
+movimentos candidatos e durações tabu), reiniciado com "seed" a cada run. Buscas com a
+mesma semente e a mesma entrada são idênticas, e buscas em threads diferentes não
+compartilham estado.
+
+- elitePool: se não nulo, pool compartilhado com outras buscas na mesma instância, frota
+e capacidade. A cada ELITE_PERIOD iterações, e ao final, a busca publica bestFeasibleSol
+se ela melhorou desde a última publicação; na intensificação, parte da melhor solução do
+pool em vez da sua, se aquela for melhor. Com o pool, o resultado depende do ritmo das
+outras buscas.
+
+- preparedInstance: instância (Graph::instanceId) para a qual closestNeighbours e
+relativeDemand foram calculados por prepare.
+
+- routeStamp: última versão atribuída a uma rota.
+
+- evaluatorVersions: versão da rota avaliada por cada routeEvaluators[r].
+
 - routeOfClient: vetor de tamanho this->g.numberVertices, ou seja, igual ao
 número de vértices. Cada posição i do vetor contém o número da rota do cliente
 i.
 
+- positionOfClient: posição do cliente i na sua rota, mantida junto com routeOfClient
+(ver indexRoute) para montar movimentos e achar vizinhos de rota sem buscas lineares.
+
 - relativeDemand: vetor de tamanho this->g.numberVertices-1, ou seja, igual ao
 número de clientes. Cada posição i do vetor contém a demanda relativa do cliente
 i - 1.
@@ -62,13 +148,24 @@ que armazena os vértices mais próximos do vértice i. Cada coluna j é o j-és
 vizinho mais próximo do vértice i. O depósito não é considerado vizinho de
 nenhum vértice.
 
-- tabuMoves: vetor de routeMoves que armazena os movimentos considerados tabu.
+- routeEvaluators: um RouteEvaluator por rota de "sol", mantendo as linhas de f e o
+custo esperado de cada rota para avaliar movimentos sem recalcular a rota inteira.
+
+- tabuExpiry: tabela (cliente x rota de origem) com a última iteração em que os movimentos
+iguais (routeMove::operator==) são tabu, em tabuExpiry[client * tabuRoutes + clientRoute].
+Consultar e inserir são O(1), e movimentos expirados não precisam ser removidos. Um
+movimento é tabu na iteração itCount se itCount <= tabuExpiry.
+
+- tabuRoutes: número de rotas de "sol", fixo durante a busca, usado como largura da tabela.
 
 - sol: melhor solução encontrada na iteração atual. É igual a variável
 "x" do paper.
 
 - bestFeasibleSol: melhor solução viável encontrada. É igual a variável
-"T*" do paper.
+"T*" do paper. Suas rotas, como as de "sol", têm capacidade para todos os clientes
+(reserveRoutes), para que copiar uma solução na outra não aloque memória.
+
+- eliteSol: cópia da melhor solução de elitePool, obtida em pullElite.
 */
 struct routeMove {
 
@@ -86,6 +183,52 @@ struct routeMove {
 struct svrpSol {
     vector<vector<int>> routes;
     double expectedCost=0.0;
+    vector<double> routeCosts;
+    vector<unsigned long> routeVersions;
+    double routesCost = 0.0;
+};
+
+struct routeChange {
+    int r1 = -1, r2 = -1;
+    int client = 0, from = 0, to = 0;
+    double cost1 = 0.0, cost2 = 0.0;
+
+    // Movimento dentro da rota r
+    void set(int r, int c, int fromPos, int toPos) {
+        r1 = r; r2 = -1; client = c; from = fromPos; to = toPos; cost1 = cost2 = 0.0;
+    }
+
+    // Movimento da rota ra para a rota rb
+    void set(int ra, int c, int fromPos, int rb, int toPos) {
+        set(ra, c, fromPos, toPos);
+        r2 = rb;
+    }
+
+    // Aplica o movimento às rotas "routes", no lugar
+    void apply(vector<vector<int>>& routes) const {
+        vector<int>& source = routes[r1];
+        vector<int>& target = routes[r2 >= 0 ? r2 : r1];
+        source.erase(source.begin() + from);
+        target.insert(target.begin() + to, client);
+    }
+
+    // Desfaz o movimento aplicado por apply
+    void undo(vector<vector<int>>& routes) const {
+        vector<int>& source = routes[r1];
+        vector<int>& target = routes[r2 >= 0 ? r2 : r1];
+        target.erase(target.begin() + to);
+        source.insert(source.begin() + from, client);
+    }
+};
+
+struct screenedMove {
+    routeMove move;
+    routeChange change;
+    bool notTabu;
+    double approxCost;
+
+    screenedMove(const routeMove& move, const routeChange& change, bool notTabu, double approxCost) :
+        move(move), change(change), notTabu(notTabu), approxCost(approxCost) {}
 };
 
 class TabuSearchSVRP {
@@ -93,32 +236,73 @@ class TabuSearchSVRP {
     
 public:
 
-    Graph g;
+    const Graph* g = NULL;
     long double penalty = 0.0, bestPenalExpCost = 0.0;
     int numVehicles = 0, capacity = 0, numSelected = 0, numNearest = 0, numRoutes = 0;
     int itCount = 0, numInfeasibleNearby = 0;
     int currNoImprovement = 0, maxNoImprovement = 0;
+    long long searchEvaluations = 0, searchAllocations = 0, poolEvaluations = 0, poolAllocations = 0;
+    vector<long long> taskEvaluations, taskAllocations;
+    unsigned long routeStamp = 0;
+    int numFinalists = 0;
+    long long screenedCandidates = 0, exactCandidates = 0;
+    double maxScreeningError = 0.0, sumScreeningError = 0.0;
+    bool lowerBounds = true;
+    long long boundedCandidates = 0, skippedEvaluations = 0;
+    bool orientRoutes = false;
+    long long reversedRoutes = 0;
+    int numThreads = 1;
+    shared_ptr<WorkerPool> pool;
+    ElitePool* elitePool = NULL;
+    unsigned int seed = 1;
+    mt19937 generator;
+    int preparedInstance = 0;
+    vector<unsigned long> evaluatorVersions;
     routeMove moveDone;
-    vector<int> routeOfClient;
+    vector<int> routeOfClient, positionOfClient;
     vector<double> relativeDemand;
     vector<vector<int>> closestNeighbours;
-    vector<routeMove> tabuMoves;
-    svrpSol sol, bestFeasibleSol;
-    svrpSol run(Graph inst, int numVehicles, int capacity);
+    vector<RouteEvaluator> routeEvaluators;
+    vector<int> tabuExpiry;
+    int tabuRoutes = 0;
+    svrpSol sol, bestFeasibleSol, eliteSol;
+    vector<routeMove> bestMoves;
+    vector<screenedMove> candidates;
+    vector<int> selected, finalistOrder;
+    vector<double> candidateCosts;
+    vector<bool> finalist;
+    svrpSol run(const Graph& inst, int numVehicles, int capacity, const vector<vector<int>>& initialRoutes = vector<vector<int>>());
+    void prepare(const Graph& inst);
 
 private:
 
     // Etapas
-    void initialize(Graph inst, int numVehicles, int capacity);
+    void initialize(const Graph& inst, int numVehicles, int capacity, const vector<vector<int>>& initialRoutes);
     void neighbourhoodSearch();
     void update();
 
     // Funções
-    double penalizedExpectedLength(vector<vector<int>> sol);
+    double penalizedExpectedLength(const routeChange& change, int numRoutes) const;
+    double evaluateChange(routeChange& change, int numRoutes) const;
+    double approximateChange(routeChange& change, int numRoutes);
+    double evaluateBounded(routeChange& change, double threshold, int numRoutes);
+    int routesAfter(const routeChange& change) const;
+    void describeMove(const routeMove& m, routeChange& change) const;
+    void indexRoute(int r);
+    void evaluateCandidates();
+    void applyChange(const routeChange& change);
+    bool orientRoute(int r);
+    void syncEvaluators();
+    void reserveRoutes(svrpSol& s);
+    bool isTabu(const routeMove& m) const;
+    void makeTabu(const routeMove& m);
+    void pullElite();
     double removalCost(int r, int client);
     double maxRemovalCost(int r);
     double approxInsertImpact(int a, int b, int c);
-    double approxMoveCost(routeMove m);
+    double approxMoveCost(const routeMove& m);
     void TwoOptSwap(int i, int j, int k);
 
 };
+
+#endif
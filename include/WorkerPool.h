@@ -0,0 +1,52 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/*
+WorkerPool: Threads persistentes para executar lotes curtos de tarefas independentes,
+como as avaliações dos candidatos de uma iteração da busca tabu, sem criar threads a
+cada lote. A thread que chama run também executa tarefas.
+
+As tarefas são distribuídas dinamicamente, então cada uma deve escrever apenas nos
+seus próprios resultados; a redução, quando houver, é feita por quem chamou run,
+depois que todas terminam e na ordem dos índices, de forma que o resultado não depende
+da ordem de execução.
+*/
+class WorkerPool {
+
+public:
+
+    // Pool com "numThreads" threads no total, contando a que chama run (0 = número de núcleos)
+    explicit WorkerPool(int numThreads);
+    ~WorkerPool();
+
+    // Executa task(0), ..., task(numTasks - 1) e retorna quando todas terminarem
+    void run(int numTasks, const function<void(int)>& task);
+
+    int size() const { return this->workers.size() + 1; }
+
+private:
+
+    vector<thread> workers;
+    mutex lock;
+    condition_variable wake, finished;
+    const function<void(int)>* task;
+    int numTasks, active;
+    atomic<int> next;
+    atomic<unsigned long> generation;
+    bool stopping;
+
+    void work();
+    void drain();
+
+};
+
+#endif
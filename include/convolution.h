@@ -0,0 +1,77 @@
+#ifndef CONVOLUTION_H
+#define CONVOLUTION_H
+
+#include "graph.h"
+
+// As linhas são completadas até um múltiplo deste valor, para os vetores AVX2/AVX-512
+#define CONV_BLOCK 16
+
+// Maior largura de suporte com kernel direto desenrolado em compilação
+#ifndef CONV_UNROLLED_WIDTH
+#define CONV_UNROLLED_WIDTH 20
+#endif
+
+/*
+DemandRows: Buffer contíguo, linha a linha, para as distribuições de carga. Cada linha
+possui "padding" posições antes da posição 0, ao menos a maior demanda de um vértice
+(ver rowPadding), permitindo que a convolução leia row[r - k] sem testes de limite, e é
+completada até um múltiplo de CONV_BLOCK.
+
+- numRows, length: número de linhas e de colunas válidas de cada linha.
+- padding: posições antes da posição 0 de cada linha.
+- stride: distância entre o início de duas linhas consecutivas em "data".
+*/
+struct DemandRows {
+
+    int numRows = 0, length = 0, padding = 0, stride = 0;
+    vector<double> data;
+
+    // Redimensiona mantendo as linhas já calculadas se "length" e "padding" não mudarem
+    void resize(int numRows, int length, int padding);
+
+    double* row(int m) { return &this->data[m * this->stride + this->padding]; }
+    const double* row(int m) const { return &this->data[m * this->stride + this->padding]; }
+
+};
+
+// Padding das linhas para as demandas de "g": Graph::demandLimit arredondado para um múltiplo de 8
+int rowPadding(const Graph& g);
+
+/*
+DemandKernel: Coeficientes da convolução de um cliente.
+- absent: probabilidade do cliente estar ausente.
+- weights[k]: probabilidade do cliente estar presente com demanda k, para k em
+[minDemand, maxDemand] (aponta para DemandDistribution::pmf). Sem demanda positiva, o
+suporte é vazio (minDemand = 1, maxDemand = 0).
+- uniform: se a demanda é uniforme no suporte, com weights[k] = uniformWeight. Nesse
+caso a convolução pode usar uma soma deslizante, com trabalho O(1) por posição.
+*/
+struct DemandKernel {
+    double absent;
+    const double* weights;
+    int minDemand, maxDemand;
+    bool uniform;
+    double uniformWeight;
+};
+
+void demandKernel(const vertex& v, DemandKernel& kernel);
+
+/* out[r] = absent * in[r] + soma de weights[k] * in[r - k], para r em [0, length).
+Suportes uniformes largos usam a soma deslizante. Os demais usam, conforme a largura
+do suporte (maxDemand - minDemand + 1): o kernel vetorizado especializado na largura,
+até CONV_UNROLLED_WIDTH; o kernel vetorizado genérico; e, a partir de
+convolutionFftWidth(), a convolução por FFT em blocos. */
+void convolveRow(const double* in, const DemandKernel& kernel, double* out, int length);
+
+// Copia as "maxDemand" últimas posições da linha para o padding, tornando a convolução circular
+void wrapRow(double* row, int length, int maxDemand);
+
+// Menor largura de suporte não uniforme convolucionada por FFT
+int convolutionFftWidth();
+
+// Conjunto de instruções usado por convolveRow ("avx512", "avx2" ou "scalar")
+const char* convolutionIsa();
+
+void benchmarkConvolution();
+
+#endif
@@ -7,20 +7,31 @@
 */
 #include<iostream>
 #include<algorithm>
+#include<atomic>
 #include<cmath>
 #include<vector>
 #include<random>
 #include<string>
 #include<time.h>
+#include "DemandDistribution.h"
 
 using namespace std;
 //using namespace lemon;
 extern char verbosity;
 
+/*
+vertex: coordenadas, probabilidade de presença e distribuição de demanda do vértice.
+probDemand[k] é a probabilidade da demanda ser k, dado que o vértice está presente, para
+qualquer suporte inteiro positivo; se "uniformDemand" for verdadeiro, ela é uniforme no
+suporte. "demand" é a distribuição combinada com a presença, montada a partir desses
+dados por computeDemandTables.
+*/
 struct vertex {
     double x, y;
-    double probDemand[21];
+    vector<double> probDemand;
     double probOfPresence = 1;
+    bool uniformDemand = false;
+    DemandDistribution demand;
 };
 
 struct edge {
@@ -34,13 +45,18 @@ public:
 
     int numberVertices = 0;
     int maxDemand = 0;
+    int demandLimit = 0; // maior demanda possível de um cliente da instância
+    int instanceId = 0; // identificador único das demandas e distâncias da instância (cópias compartilham)
     double totalExpectedDemand = 0.0;
-    vector<double> expectedDemand;
     vector<vertex> vertices;
     vector<vector<double>> adjMatrix;
+    bool symmetricDistances = false; // adjMatrix[i][j] == adjMatrix[j][i] para todo par (ver checkSymmetry)
 
     void createInstance(int n);
     void computeDistances();
+    bool checkSymmetry();
+    void computeDemandTables();
+    void renewInstanceId();
     void printInstance();
     void drawGraph(string graphName);
     vector<int> TSP();
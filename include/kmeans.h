@@ -1,3 +1,6 @@
+#ifndef KMEANS_H
+#define KMEANS_H
+
 #include <fstream>
 #include <sstream>
 #include "graph.h"
@@ -89,4 +92,6 @@ public:
     void run(vector<Point>& all_points);
 };
 
-int kmeans_main(Graph g, int numberVehicles);
+int kmeans_main(const Graph& g, int numberVehicles);
+
+#endif
@@ -0,0 +1,172 @@
+#include <chrono>
+#include "SVRP.h"
+#include "MonteCarloSVRP.h"
+#include "CheckSVRP.h"
+
+// Diferença relativa entre "value" e "expected"
+static double relativeError(double value, double expected) {
+	return fabs(value - expected) / max(1e-12, fabs(expected));
+}
+
+// Registra uma comparação, imprimindo-a se estiver fora da tolerância
+static void compare(const char* name, const vector<int>& route, int capacity, double value, double expected, double tolerance, double& maxError, int& failures) {
+
+	double error = relativeError(value, expected);
+	maxError = max(maxError, error);
+
+	if (error > tolerance) {
+		failures++;
+		cout << "FALHA " << name << " (capacidade " << capacity << ", rota";
+		for (unsigned int i = 0; i < route.size(); i++)
+			cout << " " << route[i];
+		printf("): %.12f, esperado %.12f\n", value, expected);
+	}
+}
+
+int checkExpectedLength(int numTrials, unsigned int seed) {
+
+	const double tolerance = 1e-9;
+	const int maxEnumerated = 10, maxDemandsEnumerated = 4;
+
+	Graph g;
+	g.createInstance(31);
+
+	mt19937 generator(seed);
+	vector<int> clients(g.numberVertices - 1);
+	iota(clients.begin(), clients.end(), 1);
+
+	int failures = 0;
+	double maxReference = 0, maxEvaluator = 0, maxBothWays = 0, maxGray = 0, maxDemands = 0, maxWide = 0;
+	double timeGray = 0, timeDemands = 0;
+	double worstMonteCarlo = 0, maxNormal = 0;
+	RouteEvaluator evaluator;
+
+	for (int t = 0; t < numTrials; t++) {
+
+		int capacity = g.demandLimit + generator() % 41;
+		int size = 1 + generator() % maxEnumerated;
+
+		shuffle(clients.begin(), clients.end(), generator);
+		vector<int> route(clients.begin(), clients.begin() + size);
+		vector<vector<int>> routes(1, route);
+
+		double expected = routeExpectedLength(g, capacity, route);
+
+		double reference = routeExpectedLengthReference(g, probTotalDemand(g, route), capacity, route);
+		compare("matriz f", route, capacity, reference, expected, tolerance, maxReference, failures);
+
+		// Avaliador incremental partindo de uma rota com o primeiro cliente removido
+		evaluator.assign(&g, capacity, vector<int>(route.begin() + 1, route.end()));
+		compare("RouteEvaluator", route, capacity, evaluator.costWithInsert(0, route[0]), expected, tolerance, maxEvaluator, failures);
+
+		// Cliente levado para outra posição da mesma rota, contra a avaliação da rota resultante
+		if (size > 1) {
+			int from = generator() % size, to = generator() % size;
+			vector<int> moved(route);
+			moved.erase(moved.begin() + from);
+			moved.insert(moved.begin() + to, route[from]);
+			evaluator.assign(&g, capacity, route);
+			compare("RouteEvaluator (mover)", route, capacity, evaluator.costWithMove(from, to),
+				routeExpectedLength(g, capacity, moved), tolerance, maxEvaluator, failures);
+		}
+
+		// Os dois sentidos juntos, contra a avaliação separada da rota invertida
+		double reverseCost, forwardCost = routeExpectedLengthBothWays(g, capacity, route, reverseCost);
+		compare("dois sentidos (direto)", route, capacity, forwardCost, expected, tolerance, maxBothWays, failures);
+		compare("dois sentidos (inverso)", route, capacity, reverseCost,
+			routeExpectedLength(g, capacity, vector<int>(route.rbegin(), route.rend())), tolerance, maxBothWays, failures);
+
+		auto begin = chrono::steady_clock::now();
+		double gray = bruteForce(g, capacity, routes, false);
+		timeGray += chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		compare("bruteForce (Gray)", route, capacity, gray, expected, tolerance, maxGray, failures);
+
+		if (size <= maxDemandsEnumerated) {
+			begin = chrono::steady_clock::now();
+			double demands = bruteForce(g, capacity, routes, true);
+			timeDemands += chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+			compare("bruteForce (demandas)", route, capacity, demands, expected, tolerance, maxDemands, failures);
+		}
+	}
+
+	// Rotas longas, fora do alcance das enumerações: Monte Carlo dentro de 4 erros padrão
+	for (int t = 0; t < 5; t++) {
+
+		int capacity = g.demandLimit + generator() % 41;
+
+		shuffle(clients.begin(), clients.end(), generator);
+		vector<int> route = clients;
+
+		MonteCarloOptions options;
+		options.seed = seed + t;
+		options.antithetic = true;
+		options.controlVariate = true;
+
+		double expected = routeExpectedLength(g, capacity, route);
+		MonteCarloEstimate estimate = monteCarloRouteExpectedLength(g, capacity, route, options);
+		double deviations = fabs(estimate.mean - expected) / (estimate.halfWidth / options.z);
+
+		worstMonteCarlo = max(worstMonteCarlo, deviations);
+		maxNormal = max(maxNormal, relativeError(approxRouteExpectedLength(g, capacity, route), expected));
+
+		if (deviations > 4) {
+			failures++;
+			printf("FALHA Monte Carlo (capacidade %d, %d clientes): %.6f +- %.6f, esperado %.6f\n",
+				capacity, (int)route.size(), estimate.mean, estimate.halfWidth, expected);
+		}
+	}
+
+	/* Demandas não uniformes com suportes largos, metade deles convolucionados por FFT, contra
+	a distribuição exata do estado do veículo */
+	Graph wide = g;
+	int fftWidth = convolutionFftWidth(), numWide = 8, maxWideClients = 4;
+
+	for (int i = 1; i < wide.numberVertices; i++) {
+
+		int width = 1 + generator() % (2 * fftWidth), low = 1 + generator() % 50;
+		vector<double>& p = wide.vertices[i].probDemand;
+		double total = 0;
+
+		p.assign(low + width, 0);
+		for (int k = low; k < low + width; k++) {
+			p[k] = 1 + generator() % 100;
+			total += p[k];
+		}
+		for (int k = low; k < low + width; k++)
+			p[k] /= total;
+
+		wide.vertices[i].uniformDemand = false;
+	}
+	wide.computeDemandTables();
+
+	for (int t = 0; t < numWide; t++) {
+
+		int capacity = wide.demandLimit + generator() % (2 * fftWidth);
+		int size = 1 + generator() % maxWideClients;
+
+		shuffle(clients.begin(), clients.end(), generator);
+		vector<int> route(clients.begin(), clients.begin() + size);
+		vector<vector<int>> routes(1, route);
+
+		double expected = bruteForce(wide, capacity, routes, false);
+		compare("demandas largas", route, capacity, routeExpectedLength(wide, capacity, route), expected, tolerance, maxWide, failures);
+		compare("demandas largas (matriz f)", route, capacity,
+			routeExpectedLengthReference(wide, probTotalDemand(wide, route), capacity, route), expected, tolerance, maxWide, failures);
+
+		evaluator.assign(&wide, capacity, vector<int>(route.begin() + 1, route.end()));
+		compare("demandas largas (RouteEvaluator)", route, capacity, evaluator.costWithInsert(0, route[0]), expected, tolerance, maxWide, failures);
+	}
+
+	printf("Rotas: %d (ate %d clientes), tolerancia relativa %.0e\n", numTrials, maxEnumerated, tolerance);
+	printf("matriz f:              erro maximo %.2e\n", maxReference);
+	printf("RouteEvaluator:        erro maximo %.2e\n", maxEvaluator);
+	printf("Dois sentidos:         erro maximo %.2e\n", maxBothWays);
+	printf("bruteForce (Gray):     erro maximo %.2e, %.2fs\n", maxGray, timeGray);
+	printf("bruteForce (demandas): erro maximo %.2e, %.2fs (ate %d clientes)\n", maxDemands, timeDemands, maxDemandsEnumerated);
+	printf("Demandas largas:       erro maximo %.2e (%d rotas, FFT a partir de largura %d)\n", maxWide, numWide, fftWidth);
+	printf("Monte Carlo:           maior desvio %.2f erros padrao\n", worstMonteCarlo);
+	printf("Aproximacao normal:    erro maximo %.2e (apenas informativo)\n", maxNormal);
+	printf("%s (%d falhas)\n", failures == 0 ? "OK" : "FALHOU", failures);
+
+	return failures;
+}
@@ -0,0 +1,45 @@
+#include <algorithm>
+#include "DemandDistribution.h"
+
+void DemandDistribution::build(double presence, const vector<double>& probDemand, bool uniform, int limit) {
+
+	double secondMoment = 0;
+
+	this->presence = presence;
+	this->pmf.assign(limit + 1, 0);
+	this->cdf.assign(limit + 1, 0);
+	this->tail.assign(limit + 1, 0);
+	this->mean = 0;
+	this->minDemand = 0;
+	this->maxDemand = 0;
+
+	for (int k = 1; k <= limit; k++) {
+
+		double p = (k < (int)probDemand.size()) ? probDemand[k] : 0;
+
+		if (p > 0) {
+			this->pmf[k] = presence * p;
+			this->minDemand = (this->maxDemand == 0) ? k : this->minDemand;
+			this->maxDemand = k;
+		}
+
+		this->cdf[k] = this->cdf[k - 1] + p;
+		this->mean += p * k;
+		secondMoment += presence * p * k * k;
+	}
+
+	for (int k = limit - 1; k >= 0; k--)
+		this->tail[k] = this->tail[k + 1] + this->pmf[k + 1];
+
+	this->mean *= presence;
+	this->variance = max(0.0, secondMoment - this->mean * this->mean);
+	this->uniform = uniform && this->maxDemand > 0;
+}
+
+int DemandDistribution::quantile(double u) const {
+
+	if (this->maxDemand == 0)
+		return 0;
+
+	return lower_bound(this->cdf.begin() + this->minDemand, this->cdf.begin() + this->maxDemand, u) - this->cdf.begin();
+}
@@ -0,0 +1,48 @@
+#include "ElitePool.h"
+
+ElitePool::ElitePool(int capacity, bool shareSolutions) : threshold(numeric_limits<double>::max()) {
+	this->capacity = max(1, capacity);
+	this->shareSolutions = shareSolutions;
+	this->created = chrono::steady_clock::now();
+}
+
+void ElitePool::publish(const svrpSol& s) {
+
+	if (s.routes.empty() || s.expectedCost >= this->threshold.load())
+		return;
+
+	lock_guard<mutex> guard(this->lock);
+
+	auto pos = lower_bound(this->elite.begin(), this->elite.end(), s.expectedCost, [](const svrpSol& e, double cost) {
+		return e.expectedCost < cost;
+		});
+
+	if (pos != this->elite.end() && pos->expectedCost == s.expectedCost)
+		return;
+
+	if (pos == this->elite.begin())
+		this->improvements.push_back(make_pair(chrono::duration<double>(chrono::steady_clock::now() - this->created).count(), s.expectedCost));
+
+	this->elite.insert(pos, s);
+	if ((int)this->elite.size() > this->capacity)
+		this->elite.pop_back();
+
+	if ((int)this->elite.size() == this->capacity)
+		this->threshold = this->elite.back().expectedCost;
+}
+
+bool ElitePool::best(svrpSol& s) const {
+
+	lock_guard<mutex> guard(this->lock);
+
+	if (!this->shareSolutions || this->elite.empty())
+		return false;
+
+	s = this->elite.front();
+	return true;
+}
+
+vector<pair<double, double>> ElitePool::history() const {
+	lock_guard<mutex> guard(this->lock);
+	return this->improvements;
+}
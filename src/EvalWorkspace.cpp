@@ -0,0 +1,78 @@
+#include "EvalWorkspace.h"
+#include <cstdlib>
+#include <new>
+
+#ifndef NDEBUG
+
+/* Fora de compilações com NDEBUG, operator new é substituído para contar as alocações
+de cada thread (threadAllocations). As demais formas de new e delete usam estas. */
+static thread_local long long heapAllocations = 0;
+
+void* operator new(size_t size) {
+
+	heapAllocations++;
+
+	void* p = malloc(size ? size : 1);
+	if (!p)
+		throw bad_alloc();
+
+	return p;
+}
+
+void operator delete(void* p) noexcept {
+	free(p);
+}
+
+long long threadAllocations() {
+	return heapAllocations;
+}
+
+#else
+
+long long threadAllocations() {
+	return -1;
+}
+
+#endif
+
+void EvalWorkspace::reserve(int numberVertices, int capacity, int padding) {
+
+	fitRows(this->rows, numberVertices + 1, capacity, padding);
+
+	if ((int)this->route.capacity() < numberVertices) {
+		this->allocations++;
+		this->route.reserve(numberVertices);
+		this->probExceeds.reserve(numberVertices);
+		this->probReach.reserve(numberVertices);
+		this->exceedCost.reserve(numberVertices);
+		this->reachCost.reserve(numberVertices);
+		this->kernels.reserve(numberVertices);
+		this->reverseExceeds.reserve(numberVertices);
+		this->reverseReach.reserve(numberVertices);
+	}
+}
+
+void EvalWorkspace::fitRows(DemandRows& f, int numRows, int length, int padding) {
+
+	size_t before = f.data.capacity();
+	bool sameShape = f.length == length && f.padding == padding;
+
+	if (!sameShape || f.numRows < numRows)
+		f.resize(max(numRows, sameShape ? f.numRows : 0), length, padding);
+
+	if (f.data.capacity() != before)
+		this->allocations++;
+}
+
+void EvalWorkspace::assignRoute(const vector<int>& newRoute) {
+
+	if (newRoute.size() > this->route.capacity())
+		this->allocations++;
+
+	this->route = newRoute;
+}
+
+EvalWorkspace& localWorkspace() {
+	static thread_local EvalWorkspace workspace;
+	return workspace;
+}
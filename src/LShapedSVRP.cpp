@@ -3,60 +3,15 @@
 // Exemplo TSP:
 // https://www.gurobi.com/documentation/9.0/examples/tsp_cpp_cpp.html#subsubsection:tsp_c++.cpp
 
-double partialRouteExpectedCost(vector<int> S, double uExpectedDemand, double uDistance, vector<int> T, Graph g, int Q) {
+/* Custo esperado de recurso da rota parcial (S, u, T) usado nos cortes L-shaped. Ainda
+não implementado: retorna 0, como antes, sem calcular distribuições que não seriam usadas. */
+double partialRouteExpectedCost(const vector<int>& S, double uExpectedDemand, double uDistance, const vector<int>& T, const Graph& g, int Q) {
     double expectedCost = 0.0;
 
-    vector<int> h;
-    int i;
-
-    for (i = 0; i < S.size(); i++) {
-        h.push_back(S[i]);
-    }
-    h.push_back(0);
-    for (i = 0; i < T.size(); i++) {
-        h.push_back(T[i]);
-    }
-
-    // Inicializa a matriz com probabilidades 0
-    int next, orderInRoute = 1, routeSize = h.size();
-    vector<double> v(20 * routeSize + 1, 0);
-    vector<vector<double>> f(h.size() + 1, v);
-    double probDemandK;
-
-    f[0][0] = 1; // probabilidade da carga do veiculo até o depósito ser 0
-
-    while (orderInRoute <= routeSize) {
-
-        // Considera o próximo cliente da rota
-        next = h[orderInRoute - 1];
-
-        // Probabilidade de não haver nenhuma carga até o cliente, ou seja, todos ausentes
-        f[orderInRoute][0] = (1 - g.vertices[next].probOfPresence) * f[orderInRoute - 1][0];
-
-        // Para todas as demandas até o cliente possíveis
-        for (int dem = 1; dem <= 20 * orderInRoute; dem++) {
-
-            // Probabilidade do cliente estar ausente, mantendo a mesma demanda anterior
-            f[orderInRoute][dem] += (1 - g.vertices[next].probOfPresence) * f[orderInRoute - 1][dem];
-
-            // Para todas as demandas possíveis do cliente
-            for (int k = 1; k <= min(20, dem); k++) {
-
-                // Probabilidade do cliente estar presente com uma demanda k
-                probDemandK = g.vertices[next].probOfPresence * g.vertices[next].probDemand[k];
-
-                if (probDemandK > 0) {
-                    f[orderInRoute][dem] += probDemandK * f[orderInRoute - 1][dem - k];
-                }
-            }
-        }
-        orderInRoute++;
-    }
-
     return expectedCost;
 }
 
-vector<int> buildHeuristicR(double** sol, int n, Graph g, int Q) {
+vector<int> buildHeuristicR(double** sol, int n, const Graph& g, int Q) {
     int i, j, maxClient = 0;
     double max = 0.0;
 
@@ -80,7 +35,7 @@ vector<int> buildHeuristicR(double** sol, int n, Graph g, int Q) {
     // maxClient is vi
     vector<int> h;
     h.push_back(maxClient);
-    double hExpectedDemand = g.expectedDemand[maxClient];
+    double hExpectedDemand = g.vertices[maxClient].demand.mean;
 
     while (maxClient != 0) {
         maxClient = 0;
@@ -88,8 +43,8 @@ vector<int> buildHeuristicR(double** sol, int n, Graph g, int Q) {
         double sum = 0.0;
 
         for (i = 0; i < n; i++) {
-            if (hExpectedDemand + g.expectedDemand[i] < Q) {
-                for (j = 0; j < h.size(); j++) {
+            if (hExpectedDemand + g.vertices[i].demand.mean < Q) {
+                for (j = 0; j < (int)h.size(); j++) {
                     if (i == h[j] && i != 0) {
                         sum = 0.0;
                         break;
@@ -105,7 +60,7 @@ vector<int> buildHeuristicR(double** sol, int n, Graph g, int Q) {
 
         if (maxClient != 0) {
             h.push_back(maxClient);
-            hExpectedDemand += g.expectedDemand[maxClient];
+            hExpectedDemand += g.vertices[maxClient].demand.mean;
         }
     }
 
@@ -165,16 +120,16 @@ public:
     GRBVar** x;
     int n, m, Q;
     double L;
-    Graph graph;
+    const Graph* graph; // instância compartilhada, não copiada
     vector<vector<int>> routes;
     vector<int> R, S, T, U;
 
-    optimalityCut(GRBVar** xvars, int xn, int m, double lowerBound, Graph g, int capacity) {
+    optimalityCut(GRBVar** xvars, int xn, int m, double lowerBound, const Graph& g, int capacity) {
         x = xvars;
         n = xn;
         m = m;
         L = lowerBound;
-        graph = g;
+        graph = &g;
         Q = capacity;
     }
 protected:
@@ -190,13 +145,13 @@ protected:
                     for (int i = 0; i < n; i++) {
                         xsol[i] = getNodeRel(x[i], n);
                     }
-                    R = buildHeuristicR(xsol, n, graph, Q);
+                    R = buildHeuristicR(xsol, n, *graph, Q);
                     S.clear();
                     S.push_back(R[0]);
                     T.clear();
                     double max = 0.0;
                     int argMax = 0;
-                    for (int i = 1; i < R.size(); i++) {
+                    for (unsigned int i = 1; i < R.size(); i++) {
                         if (xsol[R[i]][0] > max) {
                             max = xsol[R[i]][0];
                             argMax = i;
@@ -207,17 +162,18 @@ protected:
                     }
                     U = R;
                     remove(U.begin(), U.end(), U[S[0]]);
-                    if (!T.empty)
+                    if (!T.empty())
                         remove(U.begin(), U.end(), U[T[0]]);
                     double uExpectedDemand = 0.0;
                     double uDistance = numeric_limits<double>::max();
-                    for (int i = 0; i < U.size(); i++) {
-                        uExpectedDemand += graph.expectedDemand[U[i]];
-                        if (graph.adjMatrix[U[i]][0] < uDistance)
-                            uDistance = graph.adjMatrix[U[i]][0];
+                    for (unsigned int i = 0; i < U.size(); i++) {
+                        uExpectedDemand += graph->vertices[U[i]].demand.mean;
+                        if (graph->adjMatrix[U[i]][0] < uDistance)
+                            uDistance = graph->adjMatrix[U[i]][0];
                     }
                     // Calcular custo recurso esperado da rota S, u, T
-                    double Ph = partialRouteExpectedCost(S, uExpectedDemand, uDistance, T, graph, Q);
+                    double Ph = partialRouteExpectedCost(S, uExpectedDemand, uDistance, T, *graph, Q);
+                    (void)Ph; // Corte ainda não adicionado ao modelo
                 }
             }
 
@@ -238,13 +194,13 @@ protected:
                 // Armazenar custo esperado do segundo estágio
                 routes = buildRoutesFromSol(xsol, n);
                 /*cout << "Rotas:" << endl;
-                for (int i = 0; i < routes.size(); i++) {
-                    for (int j = 0; j < routes[i].size(); j++) {
+                for (unsigned int i = 0; i < routes.size(); i++) {
+                    for (unsigned int j = 0; j < routes[i].size(); j++) {
                         cout << routes[i][j] << " ";
                     }
                     cout << endl;
                 }*/
-                double expectedCost = totalExpectedLength(graph, Q, routes);
+                double expectedCost = totalExpectedLength(*graph, Q, routes);
 
                 // Armazenar valor da solução encontrada
                 double objValue = getDoubleInfo(GRB_CB_MIPSOL_OBJ);
@@ -285,7 +241,7 @@ protected:
     }
 };
 
-void solveSVRP(Graph g, int m, int Q, double L) {
+void solveSVRP(const Graph& g, int m, int Q, double L) {
     GRBEnv *env = NULL;
     GRBVar **x = NULL;
     GRBVar *u = NULL;
@@ -362,14 +318,14 @@ void solveSVRP(Graph g, int m, int Q, double L) {
                 if (i != j)
                     model.addGenConstrIndicator(
                         x[i][j], true, // indicator x[i][j] == 1
-                        u[i] + g.expectedDemand[j] == u[j],
+                        u[i] + g.vertices[j].demand.mean == u[j],
                         "subtourelim_" + to_string(i) + "_" + to_string(j)
                     );
             }
 
             /* Restrição u[i] >= q[i] para todo cliente:
              * - a demanda de i deve ser atendida. */
-            model.addConstr(u[i] >= g.expectedDemand[i], "met_demand_" + to_string(i));
+            model.addConstr(u[i] >= g.vertices[i].demand.mean, "met_demand_" + to_string(i));
 
             /* Restrição u[i] <= Q para todo cliente:
              * - a capacidade do veículo não pode ser ultrapassada. */
@@ -414,8 +370,8 @@ void solveSVRP(Graph g, int m, int Q, double L) {
             vector<vector<int>> routes = buildRoutesFromSol(sol, n);
             double expectedCost = totalExpectedLength(g, Q, routes);
             cout << "Rotas:" << endl;
-            for (int i = 0; i < routes.size(); i++) {
-                for (int j = 0; j < routes[i].size(); j++) {
+            for (unsigned int i = 0; i < routes.size(); i++) {
+                for (unsigned int j = 0; j < routes[i].size(); j++) {
                     cout << routes[i][j] << " ";
                 }
                 cout << endl;
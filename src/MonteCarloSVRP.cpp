@@ -0,0 +1,189 @@
+#include "SVRP.h"
+#include "MonteCarloSVRP.h"
+#include "WorkerPool.h"
+
+// Somas de um lote, com y = custo do cenário e x = custo sem recurso, ambos deslocados
+struct monteCarloSums {
+    double y = 0, yy = 0, x = 0, xx = 0, xy = 0;
+    long long count = 0;
+};
+
+// Gerador baseado em contador: mistura (seed, counter) com a função final do SplitMix64
+static inline double counterUniform(uint64_t seed, uint64_t counter) {
+
+	uint64_t z = seed + 0x9e3779b97f4a7c15ULL * (counter + 1);
+
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	z ^= z >> 31;
+
+	return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*
+monteCarloScenario: Simula o cenário "scenario" de todas as rotas, retornando em "cost"
+o custo com recurso e em "priori" o custo de visitar os clientes presentes sem voltar
+ao depósito. Os números usados são counterUniform(seed, 2*(scenario*n + j) + {0,1}),
+para o j-ésimo cliente; "flip" os troca pelos antitéticos.
+*/
+static void monteCarloScenario(const Graph& g, int capacity, const vector<vector<int>>& routes,
+	int numClients, uint64_t seed, uint64_t scenario, bool flip, vector<int>& present, vector<int>& demands, double& cost, double& priori) {
+
+	uint64_t counter = 2 * scenario * numClients;
+
+	cost = 0;
+	priori = 0;
+
+	for (unsigned int r = 0; r < routes.size(); r++) {
+
+		present.clear();
+		demands.clear();
+
+		for (unsigned int i = 0; i < routes[r].size(); i++, counter += 2) {
+
+			int client = routes[r][i];
+			double uPresence = counterUniform(seed, counter), uDemand = counterUniform(seed, counter + 1);
+
+			if (flip) {
+				uPresence = 1 - uPresence;
+				uDemand = 1 - uDemand;
+			}
+
+			if (uPresence >= g.vertices[client].probOfPresence)
+				continue;
+
+			present.push_back(client);
+			demands.push_back(g.vertices[client].demand.quantile(uDemand));
+		}
+
+		cost += realizedRouteCost(g, present, demands, capacity);
+
+		if (!present.empty()) {
+			priori += g.adjMatrix[0][present[0]] + g.adjMatrix[present.back()][0];
+			for (unsigned int i = 1; i < present.size(); i++)
+				priori += g.adjMatrix[present[i - 1]][present[i]];
+		}
+	}
+}
+
+/*
+monteCarloExpectedLength: Estima o custo esperado das rotas "routes" por simulação,
+em paralelo. Os cenários são divididos em lotes de tamanho fixo, agrupados em blocos
+de 16 * 1024 cenários. A cada rodada, as threads de um mesmo pool, criado uma vez para
+toda a simulação, executam um bloco por thread; os blocos são reduzidos na ordem, e o
+critério de parada é verificado após cada bloco, descartando os seguintes. Assim, a
+estimativa é a mesma para qualquer número de threads. A simulação para quando o
+intervalo de confiança atingir a largura desejada ou o número máximo de cenários.
+
+Com variável de controle, o estimador é média(y) - beta * (média(x) - E[x]), onde x é o
+custo sem recurso do cenário, E[x] é calculado de forma exata por routeExpectedLength
+com probabilidades de falha nulas, e beta = cov(x, y) / var(x).
+*/
+MonteCarloEstimate monteCarloExpectedLength(const Graph& g, int capacity, const vector<vector<int>>& routes, const MonteCarloOptions& options) {
+
+	MonteCarloEstimate estimate;
+	int numClients = 0;
+
+	double expectedPriori = 0;
+
+	for (unsigned int r = 0; r < routes.size(); r++) {
+
+		vector<double> zeros(routes[r].size(), 0);
+		if (!routes[r].empty())
+			expectedPriori += routeExpectedLength(g, routes[r], zeros, zeros);
+
+		numClients += routes[r].size();
+	}
+
+	if (numClients == 0)
+		return estimate;
+
+	WorkerPool pool(options.numThreads);
+	int batchSize = options.batchSize, batchesPerBlock = max(1, 16 * (1 << 10) / batchSize);
+	int blocksPerRound = pool.size(), batchesPerRound = batchesPerBlock * blocksPerRound;
+	int perObservation = options.antithetic ? 2 : 1;
+
+	// Deslocamento das somas por E[x], próximo da média, para reduzir cancelamento
+	double shift = expectedPriori;
+	monteCarloSums total;
+	long long nextScenario = 0;
+	vector<monteCarloSums> batches(batchesPerRound);
+
+	while (true) {
+
+		long long roundFirst = nextScenario / perObservation;
+
+		pool.run(batchesPerRound, [&](int b) {
+
+			vector<int> present, demands;
+			double cost, priori, cost2, priori2;
+
+			monteCarloSums& sums = batches[b];
+			long long first = roundFirst + (long long)b * batchSize;
+
+			sums = monteCarloSums();
+
+			for (long long o = first; o < first + batchSize; o++) {
+
+				monteCarloScenario(g, capacity, routes, numClients, options.seed, o, false, present, demands, cost, priori);
+
+				if (options.antithetic) {
+					monteCarloScenario(g, capacity, routes, numClients, options.seed, o, true, present, demands, cost2, priori2);
+					cost = (cost + cost2) / 2;
+					priori = (priori + priori2) / 2;
+				}
+
+				double y = cost - shift, x = priori - shift;
+				sums.y += y;
+				sums.yy += y * y;
+				sums.x += x;
+				sums.xx += x * x;
+				sums.xy += x * y;
+				sums.count++;
+			}
+		});
+
+		for (int block = 0; block < blocksPerRound; block++) {
+
+			for (int b = block * batchesPerBlock; b < (block + 1) * batchesPerBlock; b++) {
+				total.y += batches[b].y;
+				total.yy += batches[b].yy;
+				total.x += batches[b].x;
+				total.xx += batches[b].xx;
+				total.xy += batches[b].xy;
+				total.count += batches[b].count;
+			}
+
+			nextScenario += (long long)batchesPerBlock * batchSize * perObservation;
+
+			double n = total.count;
+			double meanY = total.y / n, meanX = total.x / n;
+			double varY = max(0.0, (total.yy - n * meanY * meanY) / (n - 1));
+			double varX = max(0.0, (total.xx - n * meanX * meanX) / (n - 1));
+			double covXY = (total.xy - n * meanX * meanY) / (n - 1);
+			double variance = varY;
+
+			estimate.mean = meanY + shift;
+			estimate.beta = 0;
+
+			if (options.controlVariate && varX > 0) {
+				estimate.beta = covXY / varX;
+				estimate.mean = meanY - estimate.beta * meanX + shift; // E[x - shift] = 0
+				variance = max(0.0, varY - covXY * covXY / varX);
+			}
+
+			estimate.halfWidth = options.z * sqrt(variance / n);
+			estimate.samples = total.count * perObservation;
+
+			if (estimate.samples >= options.minSamples && estimate.halfWidth <= options.relativeHalfWidth * fabs(estimate.mean))
+				return estimate;
+
+			if (estimate.samples >= options.maxSamples)
+				return estimate;
+		}
+	}
+}
+
+MonteCarloEstimate monteCarloRouteExpectedLength(const Graph& g, int capacity, const vector<int>& route, const MonteCarloOptions& options) {
+	return monteCarloExpectedLength(g, capacity, vector<vector<int>>(1, route), options);
+}
@@ -0,0 +1,163 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "MultiStartSVRP.h"
+
+MultiStartResult multiStartTabuSearch(const Graph& g, int numVehicles, int capacity, const MultiStartOptions& options) {
+
+	MultiStartResult result;
+	int numStarts = max(0, options.numStarts);
+	int numThreads = options.numThreads > 0 ? options.numThreads : max(1u, thread::hardware_concurrency());
+	numThreads = max(1, min(numThreads, numStarts));
+
+	// Sementes sorteadas em ordem, antes das threads, para não dependerem do escalonamento
+	mt19937 master(options.masterSeed);
+	result.runs.resize(numStarts);
+	for (int s = 0; s < numStarts; s++)
+		result.runs[s].seed = master();
+
+	TabuSearchSVRP base;
+	base.numFinalists = options.numFinalists;
+	base.orientRoutes = options.orientRoutes;
+	base.numThreads = options.candidateThreads;
+	base.prepare(g);
+
+	// Sem cooperação, o pool apenas registra as melhoras ao longo do tempo
+	ElitePool pool(options.eliteSize, options.cooperative);
+	base.elitePool = &pool;
+
+	vector<svrpSol> solutions(numStarts);
+	vector<thread> workers;
+	atomic<int> nextStart(0);
+	auto start = chrono::steady_clock::now();
+
+	for (int t = 0; t < numThreads; t++) {
+
+		workers.push_back(thread([&]() {
+
+			for (int s = nextStart++; s < numStarts; s = nextStart++) {
+
+				MultiStartRun& run = result.runs[s];
+				TabuSearchSVRP ts = base;
+				ts.seed = run.seed;
+
+				auto begin = chrono::steady_clock::now();
+				solutions[s] = ts.run(g, numVehicles, capacity);
+				run.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+				run.expectedCost = solutions[s].routes.empty() ? numeric_limits<double>::max() : solutions[s].expectedCost;
+				run.iterations = ts.itCount;
+				run.evaluations = ts.searchEvaluations;
+			}
+		}));
+	}
+
+	for (unsigned int t = 0; t < workers.size(); t++)
+		workers[t].join();
+
+	result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	result.history = pool.history();
+
+	// Redução na ordem das buscas
+	for (int s = 0; s < numStarts; s++) {
+		if (!solutions[s].routes.empty() && (result.bestStart < 0 || result.runs[s].expectedCost < result.best.expectedCost)) {
+			result.best = solutions[s];
+			result.bestStart = s;
+		}
+	}
+
+	return result;
+}
+
+void printMultiStart(const MultiStartResult& result) {
+
+	printf("busca     semente  custo esperado  iteracoes  avaliacoes  tempo (s)\n");
+
+	for (unsigned int s = 0; s < result.runs.size(); s++) {
+
+		const MultiStartRun& run = result.runs[s];
+
+		if (run.expectedCost == numeric_limits<double>::max())
+			printf("%5d  %10u  %14s  %9d  %10lld  %9.3f\n", s, run.seed, "inviavel", run.iterations, run.evaluations, run.seconds);
+		else
+			printf("%5d  %10u  %14.4f  %9d  %10lld  %9.3f\n", s, run.seed, run.expectedCost, run.iterations, run.evaluations, run.seconds);
+	}
+
+	if (result.bestStart < 0) {
+		cout << "Nenhuma solucao viavel encontrada" << endl;
+		return;
+	}
+
+	for (unsigned int i = 0, r = 0; i < result.best.routes.size(); i++) {
+
+		if (result.best.routes[i].empty())
+			continue;
+
+		cout << "Rota " << r++ << ": ";
+		for (unsigned int j = 0; j < result.best.routes[i].size(); j++)
+			cout << result.best.routes[i][j] << " ";
+		cout << endl;
+	}
+
+	cout << "Custo total: " << result.best.expectedCost << " (busca " << result.bestStart << ")" << endl;
+}
+
+// Melhor custo publicado até o instante "t" de "history" (infinito se nenhum)
+static double bestCostAt(const vector<pair<double, double>>& history, double t) {
+
+	double cost = numeric_limits<double>::max();
+
+	for (unsigned int i = 0; i < history.size() && history[i].first <= t; i++)
+		cost = history[i].second;
+
+	return cost;
+}
+
+// Instante em que "history" atinge custo <= "target" (negativo se nunca)
+static double timeToTarget(const vector<pair<double, double>>& history, double target) {
+
+	for (unsigned int i = 0; i < history.size(); i++)
+		if (history[i].second <= target)
+			return history[i].first;
+
+	return -1;
+}
+
+void benchmarkCooperation(const Graph& g, int numVehicles, int capacity, const MultiStartOptions& options) {
+
+	MultiStartOptions isolatedOptions = options, cooperativeOptions = options;
+	isolatedOptions.cooperative = false;
+	cooperativeOptions.cooperative = true;
+
+	MultiStartResult isolated = multiStartTabuSearch(g, numVehicles, capacity, isolatedOptions);
+	MultiStartResult cooperative = multiStartTabuSearch(g, numVehicles, capacity, cooperativeOptions);
+
+	printf("Buscas: %d, semente mestre %u, elite com %d solucoes\n", options.numStarts, options.masterSeed, options.eliteSize);
+	printf("isoladas:     custo %.4f em %.3fs\n", isolated.best.expectedCost, isolated.seconds);
+	printf("cooperativas: custo %.4f em %.3fs\n", cooperative.best.expectedCost, cooperative.seconds);
+
+	if (isolated.bestStart < 0)
+		return;
+
+	printf("tempo (s)  isoladas      cooperativas\n");
+
+	const double fractions[] = { 0.1, 0.25, 0.5, 0.75, 1.0 };
+	for (int k = 0; k < 5; k++) {
+
+		double t = fractions[k] * isolated.seconds;
+		double a = bestCostAt(isolated.history, t), b = bestCostAt(cooperative.history, t);
+
+		printf("%9.3f  ", t);
+		if (a == numeric_limits<double>::max()) printf("%-12s  ", "-"); else printf("%-12.4f  ", a);
+		if (b == numeric_limits<double>::max()) printf("%s\n", "-"); else printf("%.4f\n", b);
+	}
+
+	double target = isolated.best.expectedCost;
+	double isolatedTime = timeToTarget(isolated.history, target), cooperativeTime = timeToTarget(cooperative.history, target);
+
+	printf("Tempo ate o custo %.4f: isoladas %.3fs, cooperativas ", target, isolatedTime);
+	if (cooperativeTime < 0)
+		printf("nao atingiram\n");
+	else
+		printf("%.3fs\n", cooperativeTime);
+}
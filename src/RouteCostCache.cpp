@@ -0,0 +1,197 @@
+#include "RouteCostCache.h"
+
+RouteCostCache::RouteCostCache(int numShards, int slotsPerShard, int maxRouteLength) :
+	numShards(numShards), maxRouteLength(maxRouteLength), shards(numShards) {
+
+	// Tabela com ao menos o dobro de entradas que posições, em potência de 2
+	int tableSize = 1;
+	while (tableSize < 2 * slotsPerShard)
+		tableSize *= 2;
+
+	for (int s = 0; s < numShards; s++) {
+		this->shards[s].slots.resize(slotsPerShard);
+		this->shards[s].clients.resize((size_t)slotsPerShard * maxRouteLength);
+		this->shards[s].table.assign(tableSize, -1);
+	}
+}
+
+// FNV-1a sobre a instância, a capacidade e os clientes, seguido de uma mistura final
+uint64_t RouteCostCache::hashRoute(int instanceId, int capacity, const vector<int>& route) {
+
+	uint64_t h = 1469598103934665603ULL;
+
+	h = (h ^ (uint64_t)instanceId) * 1099511628211ULL;
+	h = (h ^ (uint64_t)capacity) * 1099511628211ULL;
+	for (unsigned int i = 0; i < route.size(); i++)
+		h = (h ^ (uint64_t)route[i]) * 1099511628211ULL;
+
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+
+	return h;
+}
+
+int RouteCostCache::findSlot(const Shard& shard, uint64_t hash, int instanceId, int capacity, const vector<int>& route) const {
+
+	int mask = shard.table.size() - 1;
+
+	for (int i = hash & mask; shard.table[i] != -1; i = (i + 1) & mask) {
+
+		const Slot& slot = shard.slots[shard.table[i]];
+
+		if (slot.hash == hash && slot.instanceId == instanceId && slot.capacity == capacity && slot.length == (int)route.size()
+				&& equal(route.begin(), route.end(), shard.clients.begin() + (size_t)shard.table[i] * this->maxRouteLength))
+			return shard.table[i];
+	}
+
+	return -1;
+}
+
+void RouteCostCache::insertInTable(Shard& shard, int slot) {
+
+	int mask = shard.table.size() - 1, i = shard.slots[slot].hash & mask;
+
+	while (shard.table[i] != -1)
+		i = (i + 1) & mask;
+
+	shard.table[i] = slot;
+}
+
+// Remove a entrada de "slot" da tabela, deslocando as seguintes para manter as sondagens
+void RouteCostCache::eraseFromTable(Shard& shard, int slot) {
+
+	int mask = shard.table.size() - 1, hole = shard.slots[slot].hash & mask;
+
+	while (shard.table[hole] != slot)
+		hole = (hole + 1) & mask;
+
+	for (int j = (hole + 1) & mask; shard.table[j] != -1; j = (j + 1) & mask) {
+
+		int home = shard.slots[shard.table[j]].hash & mask;
+
+		// A entrada em j pode ocupar o buraco se sua posição inicial não está em (hole, j]
+		bool between = (hole <= j) ? (hole < home && home <= j) : (hole < home || home <= j);
+
+		if (!between) {
+			shard.table[hole] = shard.table[j];
+			hole = j;
+		}
+	}
+
+	shard.table[hole] = -1;
+}
+
+bool RouteCostCache::find(const Graph& g, int capacity, const vector<int>& route, double& cost) {
+
+	if (!enabled())
+		return false;
+
+	uint64_t hash = hashRoute(g.instanceId, capacity, route);
+	Shard& shard = this->shards[hash % this->numShards];
+
+	lock_guard<mutex> guard(shard.lock);
+
+	int slot = findSlot(shard, hash, g.instanceId, capacity, route);
+
+	if (slot == -1) {
+		shard.stats.misses++;
+		return false;
+	}
+
+	shard.stats.hits++;
+	shard.slots[slot].referenced = true;
+	cost = shard.slots[slot].cost;
+
+	return true;
+}
+
+void RouteCostCache::insert(const Graph& g, int capacity, const vector<int>& route, double cost) {
+
+	if (!enabled() || (int)route.size() > this->maxRouteLength)
+		return;
+
+	uint64_t hash = hashRoute(g.instanceId, capacity, route);
+	Shard& shard = this->shards[hash % this->numShards];
+
+	lock_guard<mutex> guard(shard.lock);
+
+	int slot = findSlot(shard, hash, g.instanceId, capacity, route);
+
+	if (slot != -1) {
+		shard.slots[slot].cost = cost;
+		return;
+	}
+
+	int numSlots = shard.slots.size();
+
+	if (shard.numUsed < numSlots) {
+		slot = shard.numUsed++;
+	}
+	else {
+
+		// CLOCK: desmarcar posições até encontrar uma não referenciada
+		while (shard.slots[shard.hand].referenced) {
+			shard.slots[shard.hand].referenced = false;
+			shard.hand = (shard.hand + 1) % numSlots;
+		}
+
+		slot = shard.hand;
+		shard.hand = (shard.hand + 1) % numSlots;
+
+		eraseFromTable(shard, slot);
+		shard.stats.evictions++;
+	}
+
+	Slot& s = shard.slots[slot];
+	s.hash = hash;
+	s.instanceId = g.instanceId;
+	s.capacity = capacity;
+	s.length = route.size();
+	copy(route.begin(), route.end(), shard.clients.begin() + (size_t)slot * this->maxRouteLength);
+	s.cost = cost;
+	s.referenced = false;
+
+	insertInTable(shard, slot);
+	shard.stats.insertions++;
+}
+
+void RouteCostCache::clear() {
+
+	for (int i = 0; i < this->numShards; i++) {
+
+		Shard& shard = this->shards[i];
+		lock_guard<mutex> guard(shard.lock);
+
+		for (unsigned int s = 0; s < shard.slots.size(); s++)
+			shard.slots[s].referenced = false;
+
+		fill(shard.table.begin(), shard.table.end(), -1);
+		shard.hand = 0;
+		shard.numUsed = 0;
+		shard.stats = RouteCostCacheStats();
+	}
+}
+
+RouteCostCacheStats RouteCostCache::stats() const {
+
+	RouteCostCacheStats total;
+
+	for (int i = 0; i < this->numShards; i++) {
+
+		const Shard& shard = this->shards[i];
+		lock_guard<mutex> guard(shard.lock);
+
+		total.hits += shard.stats.hits;
+		total.misses += shard.stats.misses;
+		total.insertions += shard.stats.insertions;
+		total.evictions += shard.stats.evictions;
+	}
+
+	return total;
+}
+
+RouteCostCache& routeCostCache() {
+	static RouteCostCache cache;
+	return cache;
+}
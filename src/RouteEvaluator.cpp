@@ -0,0 +1,237 @@
+#include "SVRP.h"
+
+RouteEvaluator::RouteEvaluator() {
+	this->g = NULL;
+	this->capacity = 0;
+	this->cost = 0;
+}
+
+int RouteEvaluator::commonPrefix(const vector<int>& a, const vector<int>& b) const {
+
+	unsigned int k = 0;
+	while (k < a.size() && k < b.size() && a[k] == b[k])
+		k++;
+
+	return k;
+}
+
+/*
+evaluateFrom: Calcula o custo esperado da rota de rascunho de "ws", que coincide com a
+rota cacheada nas "k" primeiras posições. As linhas 0, ..., k de f e as probabilidades de
+falha das paradas anteriores a "k" são reaproveitadas; o restante é escrito em "ws".
+
+Com "limit" finito, acompanha um limitante inferior do custo, o custo a priori somado aos
+custos das falhas das paradas já avaliadas (routeFailureCosts), e interrompe a avaliação
+assim que ele atinge "limit", retornando-o com "complete" falso.
+*/
+double RouteEvaluator::evaluateFrom(int k, EvalWorkspace& ws, double limit, bool& complete) const {
+
+	const vector<int>& newRoute = ws.route;
+	int n = newRoute.size();
+	DemandRows& rows = ws.rows;
+	vector<double>& exceeds = ws.probExceeds;
+	vector<double>& reach = ws.probReach;
+	bool bounded = limit < numeric_limits<double>::max();
+	double bound = 0;
+
+	ws.scratchFrom = k;
+	complete = true;
+	ws.evaluations++;
+
+	ws.fitRows(rows, n + 1, this->capacity, this->f.padding);
+	ws.fit(exceeds, n);
+	ws.fit(reach, n);
+
+	for (int i = 0; i < k; i++) {
+		exceeds[i] = this->probExceeds[i];
+		reach[i] = this->probReach[i];
+	}
+
+	if (bounded) {
+
+		ws.fit(ws.exceedCost, n);
+		ws.fit(ws.reachCost, n);
+		bound = routeFailureCosts(*this->g, newRoute, ws.exceedCost, ws.reachCost);
+
+		for (int i = 0; i < k; i++)
+			bound += exceeds[i] * ws.exceedCost[i] + reach[i] * ws.reachCost[i];
+	}
+
+	for (int i = k; i < n; i++) {
+
+		// Margem relativa para a diferença de arredondamento em relação ao custo exato
+		if (bounded && bound - 1e-12 * fabs(bound) >= limit) {
+			complete = false;
+			return bound;
+		}
+
+		const double* row = (i == k) ? this->f.row(k) : rows.row(i);
+		residualFailureProbabilities(*this->g, this->capacity, row, newRoute[i], exceeds[i], reach[i]);
+
+		if (bounded)
+			bound += exceeds[i] * ws.exceedCost[i] + reach[i] * ws.reachCost[i];
+
+		advanceResidualLoad(*this->g, this->capacity, row, newRoute[i], rows.row(i + 1));
+	}
+
+	return routeExpectedLength(*this->g, newRoute, exceeds, reach);
+}
+
+/*
+evaluate: Como evaluateFrom, consultando antes o cache de custos de rotas quando
+"useCache" é verdadeiro. Um custo encontrado no cache não preenche o workspace, então
+as modificações da rota cacheada, que usam o workspace em seguida, não o consultam.
+Avaliações interrompidas por "limit" não são guardadas no cache.
+*/
+double RouteEvaluator::evaluate(int k, EvalWorkspace& ws, bool useCache, double limit, bool& complete) const {
+
+	RouteCostCache& cache = routeCostCache();
+	double newCost;
+
+	complete = true;
+
+	if (useCache && cache.find(*this->g, this->capacity, ws.route, newCost))
+		return newCost;
+
+	newCost = evaluateFrom(k, ws, limit, complete);
+
+	if (complete)
+		cache.insert(*this->g, this->capacity, ws.route, newCost);
+
+	return newCost;
+}
+
+double RouteEvaluator::evaluate(int k, EvalWorkspace& ws, bool useCache) const {
+	bool complete;
+	return evaluate(k, ws, useCache, numeric_limits<double>::max(), complete);
+}
+
+// Torna a rota de rascunho avaliada por último em "ws" a rota cacheada
+void RouteEvaluator::commitScratch(double newCost, EvalWorkspace& ws) {
+
+	int n = ws.route.size();
+
+	ws.fitRows(this->f, n + 1, this->capacity, this->f.padding);
+	for (int i = ws.scratchFrom + 1; i <= n; i++)
+		copy(ws.rows.row(i) - this->f.padding, ws.rows.row(i) - this->f.padding + this->f.stride, this->f.row(i) - this->f.padding);
+
+	this->route.swap(ws.route);
+	this->probExceeds.swap(ws.probExceeds);
+	this->probReach.swap(ws.probReach);
+	this->cost = newCost;
+}
+
+void RouteEvaluator::assign(const Graph* g, int capacity, const vector<int>& route, EvalWorkspace& ws) {
+
+	if (this->g != g || this->capacity != capacity) {
+		this->g = g;
+		this->capacity = capacity;
+		this->route.clear();
+		this->probExceeds.clear();
+		this->probReach.clear();
+
+		// Buffers dimensionados para a instância, já que são trocados com os do workspace
+		this->route.reserve(g->numberVertices);
+		this->probExceeds.reserve(g->numberVertices);
+		this->probReach.reserve(g->numberVertices);
+		this->f.resize(1, capacity, rowPadding(*g));
+		ws.fitRows(this->f, g->numberVertices + 1, capacity, this->f.padding);
+		ws.reserve(g->numberVertices, capacity, this->f.padding);
+
+		fill(this->f.data.begin(), this->f.data.end(), 0);
+		this->f.row(0)[0] = 1; // probabilidade da carga do veiculo até o depósito ser 0
+		wrapRow(this->f.row(0), capacity, g->demandLimit);
+	}
+
+	if (this->route.size() == route.size() && commonPrefix(this->route, route) == (int)route.size())
+		return;
+
+	ws.assignRoute(route);
+	double newCost = evaluate(commonPrefix(this->route, ws.route), ws, false);
+	commitScratch(newCost, ws);
+}
+
+void RouteEvaluator::append(int client, EvalWorkspace& ws) {
+	insert(this->route.size(), client, ws);
+}
+
+void RouteEvaluator::insert(int pos, int client, EvalWorkspace& ws) {
+
+	scratchInsert(pos, client, ws);
+	double newCost = evaluate(pos, ws, false);
+	commitScratch(newCost, ws);
+}
+
+void RouteEvaluator::remove(int pos, EvalWorkspace& ws) {
+
+	scratchRemove(pos, ws);
+	double newCost = evaluate(pos, ws, false);
+	commitScratch(newCost, ws);
+}
+
+void RouteEvaluator::scratchInsert(int pos, int client, EvalWorkspace& ws) const {
+	ws.assignRoute(this->route);
+	ws.route.insert(ws.route.begin() + pos, client);
+}
+
+void RouteEvaluator::scratchRemove(int pos, EvalWorkspace& ws) const {
+	ws.assignRoute(this->route);
+	ws.route.erase(ws.route.begin() + pos);
+}
+
+void RouteEvaluator::scratchMove(int from, int to, EvalWorkspace& ws) const {
+	ws.assignRoute(this->route);
+	ws.route.erase(ws.route.begin() + from);
+	ws.route.insert(ws.route.begin() + to, this->route[from]);
+}
+
+double RouteEvaluator::costWithInsert(int pos, int client, EvalWorkspace& ws) const {
+
+	scratchInsert(pos, client, ws);
+
+	return evaluate(pos, ws, true);
+}
+
+double RouteEvaluator::costWithRemove(int pos, EvalWorkspace& ws) const {
+
+	scratchRemove(pos, ws);
+
+	return evaluate(pos, ws, true);
+}
+
+double RouteEvaluator::costWithMove(int from, int to, EvalWorkspace& ws) const {
+
+	scratchMove(from, to, ws);
+
+	return evaluate(min(from, to), ws, true);
+}
+
+double RouteEvaluator::costWithRoute(const vector<int>& newRoute, EvalWorkspace& ws) const {
+
+	if (&newRoute != &ws.route)
+		ws.assignRoute(newRoute);
+
+	return evaluate(commonPrefix(this->route, ws.route), ws, true);
+}
+
+double RouteEvaluator::boundedCostWithRoute(const vector<int>& newRoute, double limit, bool& complete, EvalWorkspace& ws) const {
+
+	if (&newRoute != &ws.route)
+		ws.assignRoute(newRoute);
+
+	return evaluate(commonPrefix(this->route, ws.route), ws, true, limit, complete);
+}
+
+double RouteEvaluator::boundedCostWithInsert(int pos, int client, double limit, bool& complete, EvalWorkspace& ws) const {
+
+	scratchInsert(pos, client, ws);
+
+	return evaluate(pos, ws, true, limit, complete);
+}
+
+double RouteEvaluator::boundedCostWithMove(int from, int to, double limit, bool& complete, EvalWorkspace& ws) const {
+
+	scratchMove(from, to, ws);
+
+	return evaluate(min(from, to), ws, true, limit, complete);
+}
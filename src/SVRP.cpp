@@ -1,6 +1,8 @@
 #include <algorithm>
 #include <bitset>
+#include <cassert>
 #include <cmath>
+#include <thread>
 #include <time.h>
 #include "SVRP.h"
 
@@ -16,18 +18,17 @@ g: grafo do problema sendo considerado;
 orderInRoute: vetor de inteiros que indica a ordem na qual os vértices são percorridos na rota.
 
 Saída:
-f: matriz n por (20*(n-1))+1, onde n é o número de vértices do grafo.
+f: matriz n por (D*(n-1))+1, onde n é o número de vértices do grafo e D = g.demandLimit.
 f[m][r] = probabilidade da demanda total dos clientes 1, ..., m é igual a r.
 
-Observação: demanda máxima de um vértice é 20.
+Observação: demanda máxima de um vértice é g.demandLimit.
 */
-vector<vector<double>> probTotalDemand(Graph g, vector<int> route) {
+vector<vector<double>> probTotalDemand(const Graph& g, const vector<int>& route) {
 
 	// Inicializa a matriz com probabilidades 0
 	int next, orderInRoute = 1, routeSize = route.size();
-	vector<double> v(20 * routeSize + 1, 0);
+	vector<double> v(g.demandLimit * routeSize + 1, 0);
 	vector<vector<double>> f(route.size() + 1, v);
-	double probDemandK;
 
 	f[0][0] = 1; // probabilidade da carga do veiculo até o depósito ser 0
 
@@ -35,24 +36,21 @@ vector<vector<double>> probTotalDemand(Graph g, vector<int> route) {
 
 		// Considera o próximo cliente da rota
 		next = route[orderInRoute - 1];
+		const DemandDistribution& d = g.vertices[next].demand;
 
 		// Probabilidade de não haver nenhuma carga até o cliente, ou seja, todos ausentes
-		f[orderInRoute][0] = (1 - g.vertices[next].probOfPresence) * f[orderInRoute - 1][0];
+		f[orderInRoute][0] = (1 - d.presence) * f[orderInRoute - 1][0];
 
 		// Para todas as demandas até o cliente possíveis
-		for (int dem = 1; dem <= 20 * orderInRoute; dem++) {
+		for (int dem = 1; dem <= g.demandLimit * orderInRoute; dem++) {
 
 			// Probabilidade do cliente estar ausente, mantendo a mesma demanda anterior
-			f[orderInRoute][dem] += (1 - g.vertices[next].probOfPresence) * f[orderInRoute - 1][dem];
+			f[orderInRoute][dem] += (1 - d.presence) * f[orderInRoute - 1][dem];
 
-			// Para todas as demandas possíveis do cliente
-			for (int k = 1; k <= min(20, dem); k++) {
-
-				// Probabilidade do cliente estar presente com uma demanda k
-				probDemandK = g.vertices[next].probOfPresence * g.vertices[next].probDemand[k];
-
-				if (probDemandK > 0) {
-					f[orderInRoute][dem] += probDemandK * f[orderInRoute - 1][dem - k];
+			// Para todas as demandas possíveis do cliente, com a probabilidade de estar presente com cada uma
+			for (int k = d.minDemand; k <= min(d.maxDemand, dem); k++) {
+				if (d.pmf[k] > 0) {
+					f[orderInRoute][dem] += d.pmf[k] * f[orderInRoute - 1][dem - k];
 				}
 			}
 		}
@@ -62,6 +60,26 @@ vector<vector<double>> probTotalDemand(Graph g, vector<int> route) {
 	return f;
 }
 
+/*
+probTotalDemand: Mesmo que acima, com a matriz f em um buffer contíguo (ver DemandRows)
+e cada linha calculada pelo kernel de convolução.
+*/
+void probTotalDemand(const Graph& g, const vector<int>& route, DemandRows& f) {
+
+	int routeSize = route.size();
+	DemandKernel kernel;
+
+	f.resize(routeSize + 1, g.demandLimit * routeSize + 1, rowPadding(g));
+	fill(f.data.begin(), f.data.end(), 0);
+
+	f.row(0)[0] = 1; // probabilidade da carga do veiculo até o depósito ser 0
+
+	for (int orderInRoute = 1; orderInRoute <= routeSize; orderInRoute++) {
+		demandKernel(g.vertices[route[orderInRoute - 1]], kernel);
+		convolveRow(f.row(orderInRoute - 1), kernel, f.row(orderInRoute), g.demandLimit * orderInRoute + 1);
+	}
+}
+
 /*
 probReachCapacity: Calcula a probabilidade da demanda até o vértice 'i' do grafo 'g' ser
 exatamente igual a capacidade 'capacity'. Utiliza as probabilidades calculadas na função
@@ -71,7 +89,7 @@ falhas, o que é equivalente a aumentar a capacidade.
 Entrada:
 i: vértice cuja probabilidade de demanda até ele é calculado;
 g: grafo do problema sendo considerado;
-f: matriz n por (20*(n-1))+1, onde n é o número de vértices do grafo.
+f: matriz n por (D*(n-1))+1, onde n é o número de vértices do grafo e D = g.demandLimit.
 f[m][r] = probabilidade da demanda total dos clientes 1, ..., m é igual a r.
 capacity: capacidade máxima do veículo do problema.
 orderInRoute: ordem dos vértices na rota. orderInRoute[2] = 3o cliente da rota.
@@ -79,17 +97,17 @@ orderInRoute: ordem dos vértices na rota. orderInRoute[2] = 3o cliente da rota.
 Saída: double indicando a probabilidade da demanda até o vértice 'i' ser exatamente igual a
 capacidade máxima do veículo.
 */
-double probReachCapacity(int i, Graph g, vector<vector<double>> f, int capacity, vector<int> orderInRoute) {
+double probReachCapacity(int i, const Graph& g, const vector<vector<double>>& f, int capacity, const vector<int>& orderInRoute) {
 
 	double probReachCap = 0;
-	int vtx = orderInRoute[i];
+	const DemandDistribution& d = g.vertices[orderInRoute[i]].demand;
 
 	// Para todos os possíveis números de falhas "q"
-	for (int q = 1; q <= floor((i + 1) * 20 / capacity); q++) {
+	for (int q = 1; q <= floor((i + 1) * g.demandLimit / capacity); q++) {
 
 		// Para todas as possíveis "k" capacidades residuais no vértice anterior a "i"
-		for (int k = 1; k <= 20; k++) {
-			probReachCap += g.vertices[vtx].probOfPresence * g.vertices[vtx].probDemand[k] * f[i][q * capacity - k];
+		for (int k = 1; k <= g.demandLimit; k++) {
+			probReachCap += d.pmf[k] * f[i][q * capacity - k];
 		}
 	}
 
@@ -105,7 +123,7 @@ de falhas, o que é equivalente a aumentar a capacidade.
 Entrada:
 i: vértice cuja probabilidade de demanda até ele é calculado;
 g: grafo do problema sendo considerado;
-f: matriz n por (20*(n-1))+1, onde n é o número de vértices do grafo.
+f: matriz n por (D*(n-1))+1, onde n é o número de vértices do grafo e D = g.demandLimit.
 f[m][r] = probabilidade da demanda total dos clientes 1, ..., m é igual a r.
 capacity: capacidade máxima do veículo do problema.
 orderInRoute: ordem dos vértices na rota. orderInRoute[2] = 3o cliente da rota.
@@ -113,50 +131,38 @@ orderInRoute: ordem dos vértices na rota. orderInRoute[2] = 3o cliente da rota.
 Saída: double indicando a probabilidade da demanda até o vértice 'i' ser maior do que a
 capacidade máxima do veículo.
 */
-double probExceedsCapacity(int i, Graph g, vector<vector<double>> f, int capacity, vector<int> orderInRoute) {
+double probExceedsCapacity(int i, const Graph& g, const vector<vector<double>>& f, int capacity, const vector<int>& orderInRoute) {
 
-	double probExceedsCap = 0, probDemandExceeds = 0;
-	int vtx = orderInRoute[i];
+	double probExceedsCap = 0;
+	const DemandDistribution& d = g.vertices[orderInRoute[i]].demand;
 
 	// Para todos os possíveis números de falhas "q"
-	for (int q = 1; q <= floor((i + 1) * 20 / capacity); q++) {
+	for (int q = 1; q <= floor((i + 1) * g.demandLimit / capacity); q++) {
 
 		// Para todas as possíveis "k" capacidades residuais no vértice anterior a "i"
-		for (int k = 1; k <= 19; k++) {
-
-			// Para todas as possíveis demandas "r" do vértice "i" maiores do que "k"
-			for (int r = k + 1; r <= 20; r++) {
-				probDemandExceeds += g.vertices[vtx].probOfPresence * g.vertices[vtx].probDemand[r];
-			}
+		for (int k = 1; k < g.demandLimit; k++) {
 
-			/* Somar probabilidade de que a demanda em "i" é maior do que "k"
+			/* Somar probabilidade de que a demanda em "i" é maior do que "k" (d.tail[k])
 			e que a demanda anterior a "i" seja igual a q*capacity-k */
-			probExceedsCap += probDemandExceeds * f[i][q * capacity - k];
-			probDemandExceeds = 0;
+			probExceedsCap += d.tail[k] * f[i][q * capacity - k];
 		}
 	}
 
 	return probExceedsCap;
 }
 
-double probExceedsCapacity(int i, Graph g, vector<vector<double>> f, int capacity, vector<int> orderInRoute, int j) {
+double probExceedsCapacity(int i, const Graph& g, const vector<vector<double>>& f, int capacity, const vector<int>& orderInRoute, int j) {
 
-	double probExceedsCap = 0, probDemandExceeds = 0;
-	int vtx = orderInRoute[i];
+	double probExceedsCap = 0;
+	const DemandDistribution& d = g.vertices[orderInRoute[i]].demand;
 
 	// Para todas as possíveis "k" capacidades residuais no vértice anterior a "i"
-	for (int k = 1; k <= 19; k++) {
-
-		// Para todas as possíveis demandas "r" do vértice "i" maiores do que "k"
-		for (int r = k + 1; r <= 20; r++) {
-			probDemandExceeds += g.vertices[vtx].probOfPresence * g.vertices[vtx].probDemand[r];
-		}
+	for (int k = 1; k < g.demandLimit; k++) {
 
-		/* Somar probabilidade de que a demanda em "i" é maior do que "k"
+		/* Somar probabilidade de que a demanda em "i" é maior do que "k" (d.tail[k])
 		e que a demanda anterior a "i" seja igual a q*capacity-k */
-		if(j * capacity - k < 20 * orderInRoute.size() + 1)
-			probExceedsCap += probDemandExceeds * f[i][j * capacity - k];
-		probDemandExceeds = 0;
+		if(j * capacity - k < g.demandLimit * (int)orderInRoute.size() + 1)
+			probExceedsCap += d.tail[k] * f[i][j * capacity - k];
 	}
 
 	return probExceedsCap;
@@ -166,23 +172,25 @@ double probExceedsCapacity(int i, Graph g, vector<vector<double>> f, int capacit
 returnCost: Calcula o custo de ir ao depósito a partir do cliente i e retornar ao cliente j.
 i e j são as posições dos clientes na rota orderInRoute;
 */
-double returnCost(int i, int j, Graph g, vector<int> orderInRoute) {
+double returnCost(int i, int j, const Graph& g, const vector<int>& orderInRoute) {
 	return g.adjMatrix[orderInRoute[i]][0] + g.adjMatrix[0][orderInRoute[j]] - g.adjMatrix[orderInRoute[i]][orderInRoute[j]];
 }
 
 /*
-routeExpectedLength: Calcula o custo esperado de uma rota.
+routeExpectedLengthReference: Calcula o custo esperado de uma rota. Implementação original,
+em O(n^3) e recalculando as probabilidades de falha a cada par de clientes, mantida como
+oráculo para comparar as versões mais rápidas (routeExpectedLength).
 
 Entrada:
 g: grafo do problema sendo considerado;
-f: matriz n por (20*(n-1))+1, onde n é o número de vértices do grafo.
+f: matriz n por (D*(n-1))+1, onde n é o número de vértices do grafo e D = g.demandLimit.
 f[m][r] = probabilidade da demanda total dos clientes 1, ..., m ser igual a r.
 capacity: capacidade máxima do veículo do problema.
 orderInRoute: ordem dos vértices na rota. orderInRoute[2] = 3o cliente da rota.
 
 Saída: double indicando o custo esperado de se percorrer uma rota dada.
 */
-double routeExpectedLength(Graph g, vector<vector<double>> f, int capacity, vector<int> orderInRoute) {
+double routeExpectedLengthReference(const Graph& g, const vector<vector<double>>& f, int capacity, const vector<int>& orderInRoute) {
 
 	double expectedLength = 0;
 	int sizeRoute = orderInRoute.size();
@@ -266,33 +274,579 @@ double routeExpectedLength(Graph g, vector<vector<double>> f, int capacity, vect
 }
 
 /*
-totalExpectedLength: Calcula e acumula o custo esperado de todas as rotas.
+routeExpectedLength: Calcula o custo esperado de uma rota a partir da matriz f. As
+probabilidades de falha são obtidas do perfil de falhas da rota (failureProfile) e o
+custo é montado em O(n^2) (ver a versão que recebe probExceeds e probReach).
+
+Entrada:
+g: grafo do problema sendo considerado;
+f: matriz n por (D*(n-1))+1, onde n é o número de vértices do grafo e D = g.demandLimit.
+f[m][r] = probabilidade da demanda total dos clientes 1, ..., m ser igual a r.
+capacity: capacidade máxima do veículo do problema.
+orderInRoute: ordem dos vértices na rota. orderInRoute[2] = 3o cliente da rota.
+
+Saída: double indicando o custo esperado de se percorrer uma rota dada.
+*/
+double routeExpectedLength(const Graph& g, const vector<vector<double>>& f, int capacity, const vector<int>& orderInRoute) {
+
+	FailureProfile profile;
+	failureProfile(g, f, capacity, orderInRoute, profile);
+
+	return routeExpectedLength(g, orderInRoute, profile.totalExceeds, profile.totalReach);
+}
+
+/*
+advanceResidualLoad: Alternativa a uma linha de probTotalDemand que guarda apenas a
+distribuição da carga acumulada módulo a capacidade, ou seja, da carga residual desde
+o último reabastecimento. Como probReachCapacity e probExceedsCapacity somam f[i][q*capacity-k]
+para todo q, basta conhecer essa distribuição para calcular as probabilidades de falha.
+As linhas ficam em um DemandRows e a convolução circular é feita por convolveRow.
+
+Entrada:
+g: grafo do problema sendo considerado;
+capacity: capacidade máxima do veículo do problema (>= g.demandLimit, demanda máxima de um vértice);
+row: row[r] = probabilidade da carga até o vértice anterior ser congruente a r módulo capacity,
+com o padding preenchido por wrapRow;
+client: próximo cliente da rota.
+
+Saída:
+next: next[r] = probabilidade da carga até "client" ser congruente a r módulo capacity,
+já com o padding preenchido.
+*/
+void advanceResidualLoad(const Graph& g, int capacity, const double* row, int client, double* next) {
+
+	DemandKernel kernel;
+	demandKernel(g.vertices[client], kernel);
+
+	convolveRow(row, kernel, next, capacity);
+	wrapRow(next, capacity, g.demandLimit);
+}
+
+/*
+residualFailureProbabilities: Probabilidades de exceder e de atingir exatamente a
+capacidade em "client", somadas sobre todos os números de falhas, dada a distribuição
+"row" da carga residual anterior a ele (ver advanceResidualLoad).
+*/
+void residualFailureProbabilities(const Graph& g, int capacity, const double* row, int client, double& probExceeds, double& probReach) {
+
+	const DemandDistribution& d = g.vertices[client].demand;
+
+	probExceeds = 0;
+	probReach = 0;
+
+	// Para todas as possíveis "k" capacidades residuais no vértice anterior ao cliente
+	for (int k = 1; k <= d.maxDemand; k++) {
+
+		if (k >= d.minDemand)
+			probReach += d.pmf[k] * row[capacity - k];
+
+		// Probabilidade da demanda do cliente ser maior do que "k" (nula se k >= maxDemand)
+		probExceeds += d.tail[k] * row[capacity - k];
+	}
+}
+
+/*
+stopFailureProfile: Preenche, em "profile", as probabilidades da q-ésima falha ocorrer na
+parada "stop", ocupada por "client", por exceder ou por atingir exatamente a capacidade,
+para todo q. "row" é a linha de f dos clientes anteriores, com "rowLength" colunas.
+*/
+static void stopFailureProfile(const Graph& g, int capacity, const double* row, int rowLength, int stop, int client, FailureProfile& profile) {
+
+	const DemandDistribution& d = g.vertices[client].demand;
+	int idx;
+
+	for (int q = 1; q <= profile.maxFailures; q++) {
+
+		double probExceeds = 0, probReach = 0;
+
+		// Demanda anterior igual a q*capacity-k
+		for (int k = 1; k <= d.maxDemand; k++) {
+
+			idx = q * capacity - k;
+			if (idx >= rowLength)
+				continue;
+
+			if (k >= d.minDemand)
+				probReach += d.pmf[k] * row[idx];
+
+			probExceeds += d.tail[k] * row[idx];
+		}
+
+		profile.exceeds[stop][q] = probExceeds;
+		profile.reach[stop][q] = probReach;
+		profile.totalExceeds[stop] += probExceeds;
+		profile.totalReach[stop] += probReach;
+	}
+}
+
+// Prepara "profile" para uma rota de "sizeRoute" clientes e calcula a cauda da demanda total
+static void initFailureProfile(int capacity, int sizeRoute, const double* lastRow, int rowLength, FailureProfile& profile) {
+
+	profile.capacity = capacity;
+	profile.maxFailures = (rowLength - 1) / capacity; // rowLength = g.demandLimit * sizeRoute + 1
+	profile.exceeds.assign(sizeRoute, vector<double>(profile.maxFailures + 1, 0));
+	profile.reach.assign(sizeRoute, vector<double>(profile.maxFailures + 1, 0));
+	profile.totalExceeds.assign(sizeRoute, 0);
+	profile.totalReach.assign(sizeRoute, 0);
+	profile.loadExceeds.assign(profile.maxFailures + 1, 0);
+
+	// loadExceeds[q] = soma de lastRow[r] para r > q*capacity
+	double tail = 0;
+	for (int r = rowLength - 1, q = profile.maxFailures; q >= 0; q--) {
+		for (; r > q * capacity; r--)
+			tail += lastRow[r];
+		profile.loadExceeds[q] = tail;
+	}
+}
+
+/*
+failureProfile: Calcula, em uma única passagem pela matriz f, as probabilidades de falha
+de todas as paradas da rota para todo número de falhas q, além da probabilidade da
+demanda total ultrapassar q*capacity. As probabilidades de exceder usam as caudas das
+demandas pré-calculadas em cada vértice (DemandDistribution::tail).
+
+Entrada:
+g: grafo do problema sendo considerado;
+f: matriz calculada por probTotalDemand para "orderInRoute";
+capacity: capacidade máxima do veículo do problema;
+orderInRoute: ordem dos vértices na rota.
+
+Saída:
+profile: perfil de falhas da rota (ver FailureProfile).
+*/
+void failureProfile(const Graph& g, const vector<vector<double>>& f, int capacity, const vector<int>& orderInRoute, FailureProfile& profile) {
+
+	int sizeRoute = orderInRoute.size();
+
+	initFailureProfile(capacity, sizeRoute, &f[sizeRoute][0], f[sizeRoute].size(), profile);
+
+	for (int i = 0; i < sizeRoute; i++)
+		stopFailureProfile(g, capacity, &f[i][0], f[i].size(), i, orderInRoute[i], profile);
+}
+
+// Mesmo que acima, para a matriz f em um buffer contíguo
+void failureProfile(const Graph& g, const DemandRows& f, int capacity, const vector<int>& orderInRoute, FailureProfile& profile) {
+
+	int sizeRoute = orderInRoute.size();
+
+	initFailureProfile(capacity, sizeRoute, f.row(sizeRoute), f.length, profile);
+
+	for (int i = 0; i < sizeRoute; i++)
+		stopFailureProfile(g, capacity, f.row(i), f.length, i, orderInRoute[i], profile);
+}
+
+double FailureProfile::probLoadExceeds(int q) const {
+	return q <= this->maxFailures ? this->loadExceeds[q] : 0;
+}
+
+/*
+restockLowerBound: Limitante L do custo de recurso usado pelo modelo L-shaped. Para cada
+i < numVehicles, a demanda total de todos os clientes ultrapassar (numVehicles + i) vezes
+a capacidade exige ao menos mais uma ida e volta ao depósito, com custo ao menos o dobro da
+distância ao i-ésimo cliente mais próximo do depósito.
+
+Entrada:
+g: grafo do problema sendo considerado;
+profile: perfil de falhas da rota com todos os clientes (ver failureProfile);
+numVehicles: número de veículos;
+depotNeighbours: clientes mais próximos do depósito, em ordem de distância.
+
+Saída: double com o limitante L.
+*/
+double restockLowerBound(const Graph& g, const FailureProfile& profile, int numVehicles, const vector<int>& depotNeighbours) {
+
+	double L = 0.0;
+
+	for (int i = 0; i < numVehicles; i++) {
+
+		// Probabilidade da demanda total ser maior do que (numVehicles + i) * capacity
+		double P = profile.probLoadExceeds(numVehicles + i);
+
+		if (i < (int)depotNeighbours.size())
+			L += P * g.adjMatrix[0][depotNeighbours[i]];
+	}
+
+	return 2.0 * L;
+}
+
+/*
+routeExpectedLength: Calcula o custo esperado de uma rota sem construir a matriz f,
+mantendo apenas duas linhas da distribuição da carga residual. Usa O(capacity) de memória
+e tempo O(n*capacity*D), onde n é o tamanho da rota e D a demanda máxima de um cliente. A versão que recebe f é mantida
+como referência. Os buffers são os do workspace "ws", sem alocações se ele já estiver
+dimensionado para a instância.
+*/
+double routeExpectedLength(const Graph& g, int capacity, const vector<int>& orderInRoute, EvalWorkspace& ws) {
+
+	int sizeRoute = orderInRoute.size();
+	DemandRows& rows = ws.rows;
+	vector<double>& probExceeds = ws.probExceeds;
+	vector<double>& probReach = ws.probReach;
+
+	ws.evaluations++;
+	ws.fitRows(rows, 2, capacity, rowPadding(g));
+	ws.fit(probExceeds, sizeRoute);
+	ws.fit(probReach, sizeRoute);
+
+	fill(rows.row(0) - rows.padding, rows.row(0) - rows.padding + rows.stride, 0);
+	rows.row(0)[0] = 1; // probabilidade da carga do veiculo até o depósito ser 0
+	wrapRow(rows.row(0), capacity, g.demandLimit);
+
+	for (int i = 0; i < sizeRoute; i++) {
+		residualFailureProbabilities(g, capacity, rows.row(i % 2), orderInRoute[i], probExceeds[i], probReach[i]);
+		advanceResidualLoad(g, capacity, rows.row(i % 2), orderInRoute[i], rows.row((i + 1) % 2));
+	}
+
+	return routeExpectedLength(g, orderInRoute, probExceeds, probReach);
+}
+
+/*
+routeExpectedLength: Calcula o custo esperado de uma rota a partir das probabilidades de
+falha já calculadas para cada parada. Os produtos das probabilidades de ausência são
+acumulados ao longo da rota em vez de recalculados, de forma que o custo dos pares de
+clientes consecutivos (percurso e retorno ao depósito ao atingir a capacidade) é O(n^2)
+e o dos demais termos O(n).
+
+Entrada:
+g: grafo do problema sendo considerado;
+orderInRoute: ordem dos vértices na rota. orderInRoute[2] = 3o cliente da rota.
+probExceeds: probExceeds[i] = probabilidade de exceder a capacidade na parada i (nula em i = 0).
+probReach: probReach[i] = probabilidade de atingir exatamente a capacidade na parada i.
+
+Saída: double indicando o custo esperado de se percorrer uma rota dada.
+*/
+double routeExpectedLength(const Graph& g, const vector<int>& orderInRoute, const vector<double>& probExceeds, const vector<double>& probReach) {
+
+	double expectedLength = 0, probAbsent;
+	int sizeRoute = orderInRoute.size();
+
+	/* Custo de cada vértice ser o primeiro presente da rota: "probAbsent" é o produto
+	das probabilidades de ausência dos vértices anteriores */
+	probAbsent = 1;
+	for (int i = 0; i < sizeRoute; i++) {
+		const vertex& vi = g.vertices[orderInRoute[i]];
+		expectedLength += g.adjMatrix[0][orderInRoute[i]] * vi.probOfPresence * probAbsent;
+		probAbsent *= 1 - vi.probOfPresence;
+	}
+
+	// Custo de cada vértice ser o último presente da rota, percorrendo-a de trás para frente
+	probAbsent = 1;
+	for (int i = sizeRoute - 1; i >= 0; i--) {
+		const vertex& vi = g.vertices[orderInRoute[i]];
+		expectedLength += g.adjMatrix[orderInRoute[i]][0] * vi.probOfPresence * probAbsent;
+		probAbsent *= 1 - vi.probOfPresence;
+	}
+
+	for (int i = 0; i < sizeRoute; i++) {
+
+		int vi = orderInRoute[i];
+		const double* distI = &g.adjMatrix[vi][0];
+
+		// Retorno ao depósito por exceder a capacidade na parada i
+		if (i > 0)
+			expectedLength += probExceeds[i] * (distI[0] + g.adjMatrix[0][vi] - distI[vi]);
+
+		/* Para cada próximo vértice presente j, com os vértices entre i e j ausentes:
+		percurso de i a j e, se a capacidade foi atingida em i, desvio pelo depósito */
+		double probPresentI = g.vertices[vi].probOfPresence;
+		probAbsent = 1;
+
+		for (int j = i + 1; j < sizeRoute; j++) {
+
+			int vj = orderInRoute[j];
+			double probNextJ = g.vertices[vj].probOfPresence * probAbsent;
+
+			expectedLength += probNextJ * (distI[vj] * probPresentI
+				+ (distI[0] + g.adjMatrix[0][vj] - distI[vj]) * probReach[i]);
+
+			probAbsent *= 1 - g.vertices[vj].probOfPresence;
+		}
+	}
+
+	return expectedLength;
+}
+
+/*
+routeFailureCosts: Decompõe o custo esperado de uma rota (ver a versão de
+routeExpectedLength que recebe probExceeds e probReach) no custo a priori, retornado, e
+nos custos das falhas em cada parada: o custo esperado é o custo a priori somado a
+probExceeds[i] * exceedCost[i] + probReach[i] * reachCost[i], para toda parada i. Como
+esses custos não são negativos, somar apenas as paradas já avaliadas dá um limitante
+inferior do custo esperado.
+
+Entrada:
+g: grafo do problema sendo considerado;
+orderInRoute: ordem dos vértices na rota.
+
+Saída:
+exceedCost: exceedCost[i] = custo de retornar ao depósito por exceder a capacidade em i.
+reachCost: reachCost[i] = custo esperado do desvio pelo depósito até o próximo cliente
+presente, dado que a capacidade foi atingida exatamente em i.
+*/
+double routeFailureCosts(const Graph& g, const vector<int>& orderInRoute, vector<double>& exceedCost, vector<double>& reachCost) {
+
+	double aPriori = 0, probAbsent;
+	int sizeRoute = orderInRoute.size();
+
+	exceedCost.resize(sizeRoute);
+	reachCost.resize(sizeRoute);
+
+	probAbsent = 1;
+	for (int i = 0; i < sizeRoute; i++) {
+		const vertex& vi = g.vertices[orderInRoute[i]];
+		aPriori += g.adjMatrix[0][orderInRoute[i]] * vi.probOfPresence * probAbsent;
+		probAbsent *= 1 - vi.probOfPresence;
+	}
+
+	probAbsent = 1;
+	for (int i = sizeRoute - 1; i >= 0; i--) {
+		const vertex& vi = g.vertices[orderInRoute[i]];
+		aPriori += g.adjMatrix[orderInRoute[i]][0] * vi.probOfPresence * probAbsent;
+		probAbsent *= 1 - vi.probOfPresence;
+	}
+
+	for (int i = 0; i < sizeRoute; i++) {
+
+		int vi = orderInRoute[i];
+		const double* distI = &g.adjMatrix[vi][0];
+		double probPresentI = g.vertices[vi].probOfPresence;
+
+		exceedCost[i] = (i > 0) ? distI[0] + g.adjMatrix[0][vi] - distI[vi] : 0;
+		reachCost[i] = 0;
+		probAbsent = 1;
+
+		for (int j = i + 1; j < sizeRoute; j++) {
+
+			int vj = orderInRoute[j];
+			double probNextJ = g.vertices[vj].probOfPresence * probAbsent;
+
+			aPriori += probNextJ * distI[vj] * probPresentI;
+			reachCost[i] += probNextJ * (distI[0] + g.adjMatrix[0][vj] - distI[vj]);
+
+			probAbsent *= 1 - g.vertices[vj].probOfPresence;
+		}
+	}
+
+	return aPriori;
+}
+
+/*
+routeExpectedLengthBothWays: Calcula os custos esperados de uma rota percorrida nos dois
+sentidos. A distribuição da carga residual é propagada do início para o fim da rota
+(sentido direto) e do fim para o início (sentido inverso), com os coeficientes da
+convolução de cada cliente calculados uma só vez. Como as distâncias são simétricas, o
+custo a priori, os produtos das probabilidades de ausência entre cada par de clientes e
+os desvios pelo depósito são os mesmos nos dois sentidos, e os dois custos são montados
+em um único laço O(n^2).
+
+Pré-condição: g.symmetricDistances (verificada por assert); com distâncias
+assimétricas, o custo inverso estaria errado.
+
+Entrada:
+g: grafo do problema sendo considerado;
+capacity: capacidade máxima do veículo do problema;
+orderInRoute: ordem dos vértices na rota, no sentido direto.
+
+Saída: double indicando o custo esperado no sentido direto; reverseCost recebe o custo
+esperado no sentido inverso.
+*/
+double routeExpectedLengthBothWays(const Graph& g, int capacity, const vector<int>& orderInRoute, double& reverseCost, EvalWorkspace& ws) {
+
+	assert(g.symmetricDistances);
+
+	int sizeRoute = orderInRoute.size();
+	DemandRows& rows = ws.rows;
+	vector<DemandKernel>& kernels = ws.kernels;
+	vector<double>& exceeds = ws.probExceeds;
+	vector<double>& reach = ws.probReach;
+	vector<double>& reverseExceeds = ws.reverseExceeds;
+	vector<double>& reverseReach = ws.reverseReach;
+
+	ws.evaluations++;
+	ws.fitRows(rows, 4, capacity, rowPadding(g));
+	ws.fit(kernels, sizeRoute);
+	ws.fit(exceeds, sizeRoute);
+	ws.fit(reach, sizeRoute);
+	ws.fit(reverseExceeds, sizeRoute);
+	ws.fit(reverseReach, sizeRoute);
+
+	for (int i = 0; i < sizeRoute; i++)
+		demandKernel(g.vertices[orderInRoute[i]], kernels[i]);
+
+	// Linhas 0 e 1 para o sentido direto, 2 e 3 para o inverso
+	for (int m = 0; m < 4; m += 2) {
+		fill(rows.row(m) - rows.padding, rows.row(m) - rows.padding + rows.stride, 0);
+		rows.row(m)[0] = 1;
+		wrapRow(rows.row(m), capacity, g.demandLimit);
+	}
+
+	for (int i = 0; i < sizeRoute; i++) {
+
+		const double* row = rows.row(i % 2);
+		residualFailureProbabilities(g, capacity, row, orderInRoute[i], exceeds[i], reach[i]);
+		convolveRow(row, kernels[i], rows.row((i + 1) % 2), capacity);
+		wrapRow(rows.row((i + 1) % 2), capacity, g.demandLimit);
+
+		// Parada i do sentido inverso: cliente orderInRoute[j]
+		int j = sizeRoute - 1 - i;
+		const double* reverseRow = rows.row(2 + i % 2);
+		residualFailureProbabilities(g, capacity, reverseRow, orderInRoute[j], reverseExceeds[j], reverseReach[j]);
+		convolveRow(reverseRow, kernels[j], rows.row(2 + (i + 1) % 2), capacity);
+		wrapRow(rows.row(2 + (i + 1) % 2), capacity, g.demandLimit);
+	}
+
+	double aPriori = 0, forwardFailures = 0, reverseFailures = 0, probAbsent;
+
+	/* Primeiro e último vértices presentes: no sentido inverso, os papéis se trocam e a
+	soma é a mesma */
+	probAbsent = 1;
+	for (int i = 0; i < sizeRoute; i++) {
+		const vertex& vi = g.vertices[orderInRoute[i]];
+		aPriori += g.adjMatrix[0][orderInRoute[i]] * vi.probOfPresence * probAbsent;
+		probAbsent *= 1 - vi.probOfPresence;
+	}
+
+	probAbsent = 1;
+	for (int i = sizeRoute - 1; i >= 0; i--) {
+		const vertex& vi = g.vertices[orderInRoute[i]];
+		aPriori += g.adjMatrix[orderInRoute[i]][0] * vi.probOfPresence * probAbsent;
+		probAbsent *= 1 - vi.probOfPresence;
+	}
+
+	for (int i = 0; i < sizeRoute; i++) {
+
+		int vi = orderInRoute[i];
+		const double* distI = &g.adjMatrix[vi][0];
+		double probPresentI = g.vertices[vi].probOfPresence;
+		double exceedCost = distI[0] + g.adjMatrix[0][vi] - distI[vi];
+
+		// Exceder a capacidade na primeira parada de cada sentido é impossível
+		if (i > 0)
+			forwardFailures += exceeds[i] * exceedCost;
+		if (i < sizeRoute - 1)
+			reverseFailures += reverseExceeds[i] * exceedCost;
+
+		/* Par (i, j) com os vértices entre eles ausentes: j é o próximo presente depois
+		de i no sentido direto, e i o próximo depois de j no inverso */
+		probAbsent = 1;
+
+		for (int j = i + 1; j < sizeRoute; j++) {
+
+			int vj = orderInRoute[j];
+			double probPresentJ = g.vertices[vj].probOfPresence;
+			double detour = distI[0] + g.adjMatrix[0][vj] - distI[vj];
+
+			aPriori += probPresentI * probPresentJ * probAbsent * distI[vj];
+			forwardFailures += probPresentJ * probAbsent * detour * reach[i];
+			reverseFailures += probPresentI * probAbsent * detour * reverseReach[j];
+
+			probAbsent *= 1 - probPresentJ;
+		}
+	}
+
+	reverseCost = aPriori + reverseFailures;
+
+	return aPriori + forwardFailures;
+}
+
+// P(S >= x) para S inteira aproximada pela normal de média "mean" e variância "variance"
+static double normalProbAtLeast(double x, double mean, double variance) {
+
+	if (variance < 1e-12)
+		return mean >= x - 0.5 ? 1 : 0;
+
+	return 0.5 * erfc((x - 0.5 - mean) / sqrt(2 * variance));
+}
+
+/*
+approxRouteExpectedLength: Aproximação do custo esperado de uma rota em que a demanda
+acumulada até cada parada é aproximada por uma normal, com a média e a variância
+acumuladas das demandas dos clientes (DemandDistribution). A probabilidade da q-ésima falha
+ocorrer na parada i é P(S_i >= q*capacity) - P(S_{i-1} >= q*capacity), com correção de
+continuidade. Supondo a densidade de S_{i-1} aproximadamente constante perto de
+q*capacity, a fração dessas falhas em que a capacidade é atingida exatamente é
+presence / mean da demanda do cliente. Apenas os q a até 6 desvios padrão da média
+são considerados, e com desvio padrão maior do que a capacidade a soma em q tem forma
+fechada, de forma que as probabilidades custam O(n); o custo é montado como em
+routeExpectedLength. Usada para ordenar candidatos na busca tabu.
+*/
+double approxRouteExpectedLength(const Graph& g, int capacity, const vector<int>& orderInRoute, EvalWorkspace& ws) {
+
+	int sizeRoute = orderInRoute.size();
+	vector<double>& probExceeds = ws.probExceeds;
+	vector<double>& probReach = ws.probReach;
+	double mean = 0, variance = 0;
+
+	ws.fit(probExceeds, sizeRoute);
+	ws.fit(probReach, sizeRoute);
+
+	// tail[q - firstQ] = P(S_{i-1} >= q*capacity), reaproveitado como P(S_i >= q*capacity)
+	double tail[64], nextTail[64];
+	int firstQ = 1, lastQ = 0;
+
+	for (int i = 0; i < sizeRoute; i++) {
+
+		const DemandDistribution& d = g.vertices[orderInRoute[i]].demand;
+		double nextMean = mean + d.mean, nextVariance = variance + d.variance;
+		double spread = 6 * sqrt(nextVariance);
+		int nextFirstQ = max(1, (int)floor((mean - spread) / capacity));
+		int nextLastQ = min(nextFirstQ + 63, (int)ceil((nextMean + spread + g.demandLimit) / capacity));
+
+		double probFailure = 0;
+
+		/* Com desvio padrão maior do que a capacidade, a soma em q é, a menos de um erro
+		da ordem de exp(-2*pi^2*variance/capacity^2), o número esperado de múltiplos da
+		capacidade cruzados pela demanda do cliente: mean / capacity */
+		if (variance >= (double)capacity * capacity) {
+			probFailure = d.mean / capacity;
+			nextFirstQ = 1;
+			nextLastQ = 0;
+		}
+
+		for (int q = nextFirstQ; q <= nextLastQ; q++) {
+
+			double before = (q >= firstQ && q <= lastQ) ? tail[q - firstQ] : normalProbAtLeast(q * capacity, mean, variance);
+
+			nextTail[q - nextFirstQ] = normalProbAtLeast(q * capacity, nextMean, nextVariance);
+			probFailure += max(0.0, nextTail[q - nextFirstQ] - before);
+		}
+
+		double fractionReach = d.mean > 0 ? min(1.0, d.presence / d.mean) : 0;
+
+		probReach[i] = probFailure * fractionReach;
+		probExceeds[i] = (i > 0) ? probFailure - probReach[i] : 0;
+
+		copy(nextTail, nextTail + (nextLastQ - nextFirstQ + 1), tail);
+		firstQ = nextFirstQ;
+		lastQ = nextLastQ;
+		mean = nextMean;
+		variance = nextVariance;
+	}
+
+	return routeExpectedLength(g, orderInRoute, probExceeds, probReach);
+}
+
+/*
+totalExpectedLength: Calcula e acumula o custo esperado de todas as rotas. O custo de
+cada rota é obtido do cache compartilhado (routeCostCache) quando já foi avaliado.
 
 Saída: double indicando o custo esperado de se percorrer todas as rotas.
 */
 
-double totalExpectedLength(Graph g, int capacity, vector<vector<int>> routes) {
+double totalExpectedLength(const Graph& g, int capacity, const vector<vector<int>>& routes, EvalWorkspace& ws) {
 
 	double totalExpLength = 0;
+	RouteCostCache& cache = routeCostCache();
 
 	for (unsigned int r = 0; r < routes.size(); r++) {
 
 		if (routes[r].size() == 0)
 			continue;
-		vector<vector<double>> f = probTotalDemand(g, routes[r]);
-		double routeExpLength = routeExpectedLength(g, f, capacity, routes[r]);
-
-		if (false) {//verbosity == 'y') {
-			cout << "------------------------------------------------------------\n\n";
-			cout << "f(i,j): prob. of total demand being equal to j on the ith client of the route\n\n";
-			for (unsigned int i = 1; i <= routes[r].size(); i++) {
-				for (unsigned int j = 0; j <= 20 * routes[r].size(); j++) {
-					cout << "f(" << i << "," << j << "): ";
-					cout << f[i][j] << " ";
-				}
-				cout << "\n\n";
-			}
-			cout << "------------------------------------------------------------\n\n";
+		double routeExpLength;
+
+		if (!cache.find(g, capacity, routes[r], routeExpLength)) {
+			routeExpLength = routeExpectedLength(g, capacity, routes[r], ws);
+			cache.insert(g, capacity, routes[r], routeExpLength);
 		}
 
 		//cout << "Expected length of route " << r + 1 << ": ";
@@ -359,16 +913,28 @@ vector<vector<int>> randomRoutes(int numberVertices, int numberVehicles) {
 
 }
 
-double costCen(vector<vector<int>> A, vector<int> B, Graph g, vector<int> route, int capacity) {
+/*
+realizedRouteCost: Custo de percorrer "route" em um cenário realizado, em que os
+clientes de "route" são os presentes e demands[i] é a demanda de route[i]. Ao atingir
+exatamente a capacidade o veículo volta ao depósito e segue dele para o próximo
+cliente; ao excedê-la, vai ao depósito e retorna ao mesmo cliente.
+
+Saída: double indicando o custo do cenário.
+*/
+double realizedRouteCost(const Graph& g, const vector<int>& route, const vector<int>& demands, int capacity) {
 
-	int iter = 0, currCap = 0, currClient = 0, proxClient = route[0];
+	if (route.empty())
+		return 0;
+
+	unsigned int iter = 0;
+	int currCap = 0, currClient = 0, proxClient = route[0];
 	double costRoute = 0;
 
 	while (iter != route.size() - 1) {
 
 		costRoute += g.adjMatrix[currClient][proxClient];
 
-		if (currCap + A[iter][B[iter]] == capacity) {
+		if (currCap + demands[iter] == capacity) {
 
 			costRoute += g.adjMatrix[proxClient][0];
 			currCap = 0;
@@ -377,7 +943,7 @@ double costCen(vector<vector<int>> A, vector<int> B, Graph g, vector<int> route,
 			proxClient = route[iter];
 		}
 
-		else if (currCap + A[iter][B[iter]] > capacity) {
+		else if (currCap + demands[iter] > capacity) {
 
 			costRoute += g.adjMatrix[proxClient][0];
 			currCap = currCap - capacity;
@@ -386,7 +952,7 @@ double costCen(vector<vector<int>> A, vector<int> B, Graph g, vector<int> route,
 
 		else {
 
-			currCap += A[iter][B[iter]];
+			currCap += demands[iter];
 			iter++;
 			currClient = proxClient;
 			proxClient = route[iter];
@@ -396,7 +962,7 @@ double costCen(vector<vector<int>> A, vector<int> B, Graph g, vector<int> route,
 
 	costRoute += g.adjMatrix[currClient][proxClient];
 
-	if (currCap + A[iter][B[iter]] > capacity) {
+	if (currCap + demands[iter] > capacity) {
 
 		costRoute += g.adjMatrix[proxClient][0];
 		costRoute += g.adjMatrix[0][proxClient];
@@ -411,87 +977,217 @@ double costCen(vector<vector<int>> A, vector<int> B, Graph g, vector<int> route,
 	return costRoute;
 }
 
-double bruteForce(Graph g, int capacity, vector<vector<int>> routes) {
+// Custo do cenário em que route[i] tem demanda A[i][B[i]] (ver bruteForceCost)
+double costCen(const vector<vector<int>>& A, const vector<int>& B, const Graph& g, const vector<int>& route, int capacity) {
 
-	double expectedRoutesCost = 0, acc, acc1;
-	vector<int> presence, cenRoute;
-	unsigned int iter = 0;
+	vector<int> demands(route.size());
 
-	for (unsigned int i = 0; i < routes.size(); i++) {
+	for (unsigned int i = 0; i < route.size(); i++)
+		demands[i] = A[i][B[i]];
 
-		presence.resize(routes[i].size());
-		presence[0] = 1;
-		for (unsigned int j = 1; j < routes[i].size(); j++) {
-			presence[j] = 0;
-		}
+	return realizedRouteCost(g, route, demands, capacity);
+}
+
+/*
+presentRouteExpectedCost: Custo esperado de "route" supondo todos os clientes presentes,
+calculado exatamente pela distribuição do estado do veículo ao chegar em cada cliente
+(carga já entregue e se vem do depósito), seguindo a mesma política de realizedRouteCost.
+Equivale a bruteForceCost sem enumerar as combinações de demandas, sendo independente
+das probabilidades de falha usadas por routeExpectedLength.
+*/
+double presentRouteExpectedCost(const Graph& g, int capacity, const vector<int>& route) {
 
-		acc1 = 0;
-		for (int k = 0; k < pow(2, routes[i].size()) - 1; k++) {
+	int numClients = route.size();
 
-			for (unsigned int l = 0; l < routes[i].size(); l++) {
-				if (presence[l] == 1)
-					cenRoute.push_back(routes[i][l]);
-			}
+	if (numClients == 0)
+		return 0;
 
-			acc = bruteForceCost(g, capacity, cenRoute);
-			for (unsigned int j = 0; j < routes[i].size(); j++) {
-				if (presence[j] == 0) {
-					acc *= (1 - g.vertices[routes[i][j]].probOfPresence);
-				}
-				else {
-					acc *= g.vertices[routes[i][j]].probOfPresence;
+	// state[fromDepot][c]: probabilidade de chegar ao cliente com carga entregue c
+	vector<vector<double>> state(2, vector<double>(capacity, 0)), next(2, vector<double>(capacity, 0));
+	double expectedCost = 0;
+
+	state[1][0] = 1;
+
+	for (int i = 0; i < numClients; i++) {
+
+		int client = route[i], previous = (i > 0) ? route[i - 1] : 0;
+		const DemandDistribution& demand = g.vertices[client].demand;
+		bool last = (i == numClients - 1);
+
+		for (int from = 0; from < 2; from++)
+			fill(next[from].begin(), next[from].end(), 0);
+
+		for (int from = 0; from < 2; from++) {
+			for (int c = 0; c < capacity; c++) {
+
+				double prob = state[from][c];
+				if (prob == 0)
+					continue;
+
+				expectedCost += prob * g.adjMatrix[from ? 0 : previous][client];
+
+				for (int d = demand.minDemand; d <= demand.maxDemand; d++) {
+
+					double probD = prob * g.vertices[client].probDemand[d];
+					if (probD == 0)
+						continue;
+
+					if (c + d == capacity) {
+						expectedCost += probD * g.adjMatrix[client][0];
+						next[1][0] += probD;
+					}
+					else if (c + d > capacity) {
+						expectedCost += probD * (g.adjMatrix[client][0] + g.adjMatrix[0][client]);
+						if (last)
+							expectedCost += probD * g.adjMatrix[client][0];
+						next[0][c + d - capacity] += probD;
+					}
+					else {
+						if (last)
+							expectedCost += probD * g.adjMatrix[client][0];
+						next[0][c + d] += probD;
+					}
 				}
 			}
+		}
+
+		state.swap(next);
+	}
+
+	return expectedCost;
+}
+
+/*
+bruteForce: Custo esperado das rotas enumerando todos os subconjuntos de clientes
+presentes de cada rota. Os subconjuntos seguem o código de Gray, de forma que
+subconjuntos consecutivos diferem em um cliente: a rota presente e a probabilidade do
+subconjunto (produtos a partir de cada cliente, sem divisões) são atualizadas a cada
+troca, em vez de recalculadas. A sequência é dividida em até 64 blocos contíguos
+distribuídos entre "numThreads" threads (0 = número de núcleos). Os blocos são
+reduzidos na ordem, então o resultado não depende do número de threads. Para cada
+subconjunto, o custo com os clientes presentes é obtido enumerando as demandas
+(bruteForceCost) ou, se "enumerateDemands" for falso, pela distribuição exata do
+estado do veículo (presentRouteExpectedCost).
+*/
+double bruteForce(const Graph& g, int capacity, const vector<vector<int>>& routes, bool enumerateDemands, int numThreads) {
+
+	double expectedRoutesCost = 0;
+
+	if (numThreads <= 0)
+		numThreads = max(1u, thread::hardware_concurrency());
+
+	for (unsigned int r = 0; r < routes.size(); r++) {
+
+		const vector<int>& route = routes[r];
+		int numClients = route.size();
+		unsigned long long numSubsets = 1ULL << numClients;
+
+		int numChunks = (int)min<unsigned long long>(numSubsets, 64);
+		vector<double> chunkCost(numChunks, 0);
+		vector<thread> workers;
+
+		for (int t = 0; t < numThreads; t++) {
+
+			workers.push_back(thread([&, t]() {
+
+				vector<int> presentRoute;
+				vector<bool> present(numClients);
+				// suffix[j]: produto dos fatores (p ou 1 - p) dos clientes j, ..., numClients - 1
+				vector<double> suffix(numClients + 1, 1);
+
+				for (int chunk = t; chunk < numChunks; chunk += numThreads) {
+
+					unsigned long long first = numSubsets * chunk / numChunks, last = numSubsets * (chunk + 1) / numChunks;
+					unsigned long long gray = first ^ (first >> 1);
 
-			cenRoute.clear();
-			iter = 0;
-			while (iter < routes[i].size()) {
-				if (presence[iter] == 0) {
-					presence[iter] = 1;
-					break;
+					presentRoute.clear();
+					for (int j = 0; j < numClients; j++) {
+						present[j] = (gray >> j) & 1;
+						if (present[j])
+							presentRoute.push_back(route[j]);
+					}
+
+					for (int j = numClients - 1; j >= 0; j--) {
+						double p = g.vertices[route[j]].probOfPresence;
+						suffix[j] = suffix[j + 1] * (present[j] ? p : 1 - p);
+					}
+
+					for (unsigned long long k = first; k < last; k++) {
+
+						// Passar ao próximo código de Gray: inverter o bit do menor 1 de k. Só os
+						// fatores 0..j mudam, e o cliente entra ou sai da rota na sua posição.
+						if (k > first) {
+							int j = __builtin_ctzll(k), position = 0;
+							present[j] = !present[j];
+
+							for (int i = 0; i < j; i++)
+								position += present[i];
+
+							if (present[j])
+								presentRoute.insert(presentRoute.begin() + position, route[j]);
+							else
+								presentRoute.erase(presentRoute.begin() + position);
+
+							for (int i = j; i >= 0; i--) {
+								double p = g.vertices[route[i]].probOfPresence;
+								suffix[i] = suffix[i + 1] * (present[i] ? p : 1 - p);
+							}
+						}
+
+						double probSubset = suffix[0];
+
+						if (presentRoute.empty() || probSubset == 0)
+							continue;
+
+						double cost = enumerateDemands ? bruteForceCost(g, capacity, presentRoute) : presentRouteExpectedCost(g, capacity, presentRoute);
+						chunkCost[chunk] += probSubset * cost;
+					}
 				}
-				presence[iter] = 0;
-				iter++;
-			}
-			acc1 += acc;
+			}));
 		}
-		expectedRoutesCost += acc1;
+
+		for (unsigned int t = 0; t < workers.size(); t++)
+			workers[t].join();
+
+		for (int chunk = 0; chunk < numChunks; chunk++)
+			expectedRoutesCost += chunkCost[chunk];
 	}
 
 	return expectedRoutesCost;
 
 }
 
-double bruteForceCost(Graph g, int capacity, vector<int> route) {
+/*
+bruteForceCost: Custo esperado de "route" com todos os clientes presentes, enumerando
+todas as combinações de demandas com probabilidade positiva (suporte de cada cliente).
+Exponencial no tamanho da rota; usada apenas para verificação.
+*/
+double bruteForceCost(const Graph& g, int capacity, const vector<int>& route) {
 
 	if (route.empty())
 		return 0;
 
-	double expectedRouteCost = 0, expectedCenCost = 0;
-	int numClients = route.size(), numDiffDemand = 11, i, j, k;
+	double expectedRouteCost = 0;
+	int numClients = route.size(), i, j;
 
-	vector<int> col(numDiffDemand + 1, -1);
-	vector<vector<int>> A(numClients, col);
+	// A[i]: demandas possíveis de route[i], terminadas por -1
+	vector<vector<int>> A(numClients);
 
 	for (i = 0; i < numClients; i++) {
 
-		k = 0;
-		while (g.vertices[route[i]].probDemand[k] == 0) k++;
+		const DemandDistribution& d = g.vertices[route[i]].demand;
 
-		for (j = 0; j < numDiffDemand; j++) {
-
-			if (g.vertices[route[i]].probDemand[k] != 0)
-				A[i][j] = k;
-			else
-				break;
-
-			k++;
+		for (int k = d.minDemand; k <= d.maxDemand; k++) {
+			if (d.pmf[k] > 0)
+				A[i].push_back(k);
 		}
+
+		A[i].push_back(-1);
 	}
 
 	vector<int> B(numClients, 0);
 
-	for (i = 0; i < pow(numDiffDemand, numClients); i++) {
+	while (true) {
 
 		double acc = costCen(A, B, g, route, capacity);
 
@@ -505,7 +1201,7 @@ double bruteForceCost(Graph g, int capacity, vector<int> route) {
 
 			if (A[j][B[j] + 1] != -1) {
 
-				for (k = j - 1; k > -1; k--)
+				for (int k = j - 1; k > -1; k--)
 					B[k] = 0;
 
 				B[j]++;
@@ -521,7 +1217,7 @@ double bruteForceCost(Graph g, int capacity, vector<int> route) {
 	return expectedRouteCost;
 }
 
-void drawRoutes(Graph g, svrpSol solution, string nameOutputFile) {
+void drawRoutes(Graph g, const svrpSol& solution, const string& nameOutputFile) {
 
 	vector<int> l(g.numberVertices, -1);
 	vector<vector<int>> routeMatrix(g.numberVertices, l);
@@ -558,6 +1254,8 @@ void drawRoutes(Graph g, svrpSol solution, string nameOutputFile) {
 		}
 	}
 
+	// A cópia do grafo não tem mais as distâncias da instância
+	g.renewInstanceId();
 	g.drawGraph(nameOutputFile);
 
 }
@@ -0,0 +1,111 @@
+#include "SweepSVRP.h"
+
+// Preenche "result" com a busca de "ts" recém executada e o limitante L da frota
+static void finishResult(const Graph& g, const TabuSearchSVRP& ts, const FailureProfile& profile, double seconds, SweepResult& result) {
+
+	result.expectedLoad = g.totalExpectedDemand / ((double)result.numVehicles * result.capacity);
+	result.seconds = seconds;
+	result.iterations = ts.itCount;
+	result.lowerBound = restockLowerBound(g, profile, result.numVehicles, ts.closestNeighbours[0]);
+}
+
+vector<SweepResult> capacitySweep(const Graph& g, int numVehicles, const vector<int>& capacities) {
+
+	vector<SweepResult> results;
+	vector<int> allClients(g.numberVertices - 1);
+	iota(allClients.begin(), allClients.end(), 1);
+
+	// Distribuição da demanda total, que não depende da capacidade
+	DemandRows f;
+	probTotalDemand(g, allClients, f);
+
+	// Vizinhos e demandas relativas calculados uma vez para todas as buscas
+	TabuSearchSVRP ts;
+	ts.prepare(g);
+
+	for (unsigned int i = 0; i < capacities.size(); i++) {
+
+		SweepResult result;
+		result.numVehicles = numVehicles;
+		result.capacity = max(capacities[i], g.demandLimit);
+
+		clock_t begin = clock();
+		result.solution = ts.run(g, numVehicles, result.capacity);
+		double seconds = ((double)clock() - (double)begin) / CLOCKS_PER_SEC;
+
+		FailureProfile profile;
+		failureProfile(g, f, result.capacity, allClients, profile);
+		finishResult(g, ts, profile, seconds, result);
+
+		results.push_back(result);
+	}
+
+	return results;
+}
+
+vector<SweepResult> fleetSweep(const Graph& g, int capacity, int minVehicles, int maxVehicles) {
+
+	vector<int> allClients(g.numberVertices - 1);
+	iota(allClients.begin(), allClients.end(), 1);
+
+	capacity = max(capacity, g.demandLimit);
+	minVehicles = max(minVehicles, 1);
+	maxVehicles = min(maxVehicles, g.numberVertices - 1);
+
+	if (minVehicles > maxVehicles)
+		return vector<SweepResult>();
+
+	vector<SweepResult> results(maxVehicles - minVehicles + 1);
+
+	// Perfil de falhas da capacidade, comum a todas as frotas
+	DemandRows f;
+	FailureProfile profile;
+	probTotalDemand(g, allClients, f);
+	failureProfile(g, f, capacity, allClients, profile);
+
+	TabuSearchSVRP ts;
+	ts.prepare(g);
+	vector<vector<int>> warmStart;
+
+	for (int m = maxVehicles; m >= minVehicles; m--) {
+
+		SweepResult& result = results[m - minVehicles];
+		result.numVehicles = m;
+		result.capacity = capacity;
+
+		clock_t begin = clock();
+		result.solution = ts.run(g, m, capacity, warmStart);
+		double seconds = ((double)clock() - (double)begin) / CLOCKS_PER_SEC;
+
+		finishResult(g, ts, profile, seconds, result);
+
+		// Sem solução viável, a próxima frota parte das rotas de ida e volta
+		warmStart = result.solution.routes;
+	}
+
+	return results;
+}
+
+void printSweep(const Graph& g, const vector<SweepResult>& results) {
+
+	printf("Varredura: %d clientes, demanda esperada total %.2f\n", g.numberVertices - 1, g.totalExpectedDemand);
+	printf("veiculos  capacidade  ocupacao  custo esperado  rotas  limitante L  iteracoes  tempo (s)\n");
+
+	for (unsigned int i = 0; i < results.size(); i++) {
+
+		const SweepResult& r = results[i];
+		int numRoutes = 0;
+
+		// A solução mantém as rotas esvaziadas durante a busca
+		for (unsigned int j = 0; j < r.solution.routes.size(); j++)
+			if (!r.solution.routes[j].empty())
+				numRoutes++;
+
+		if (r.solution.routes.empty())
+			printf("%8d  %10d  %8.3f  %14s  %5s  %11.4f  %9d  %9.3f\n", r.numVehicles, r.capacity, r.expectedLoad, "inviavel", "-",
+				r.lowerBound, r.iterations, r.seconds);
+		else
+			printf("%8d  %10d  %8.3f  %14.4f  %5d  %11.4f  %9d  %9.3f\n", r.numVehicles, r.capacity, r.expectedLoad, r.solution.expectedCost,
+				numRoutes, r.lowerBound, r.iterations, r.seconds);
+	}
+}
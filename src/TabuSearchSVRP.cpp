@@ -1,12 +1,30 @@
 #include "SVRP.h"
+#include "ElitePool.h"
 
-// Fluxo de execução da busca tabu
-svrpSol TabuSearchSVRP::run(Graph inst, int numVehicles, int capacity) {
+/* Imprime o custo penalizado de um candidato. É chamada pela thread da busca, depois
+das avaliações, para que a saída não dependa das threads do pool. */
+static void printPenalizedCost(double cost) {
+
+	if (verbosity == 'y')
+		cout << "Custo penalizado total: " << cost << endl;
+}
+
+/* Fluxo de execução da busca tabu. A busca parte de "initialRoutes" se não for vazio
+(rotas vazias são ignoradas) e, senão, de uma rota de ida e volta por cliente. Como os
+movimentos nunca criam rotas, uma solução inicial com menos de numVehicles rotas não
+alcança a viabilidade. */
+svrpSol TabuSearchSVRP::run(const Graph& inst, int numVehicles, int capacity, const vector<vector<int>>& initialRoutes) {
 
 	if (inst.numberVertices > 2) {
 
-		initialize(inst, numVehicles, capacity);
+		initialize(inst, numVehicles, capacity, initialRoutes);
 		int i;
+
+		// Contadores durante as iterações, com os buffers já dimensionados em initialize
+		EvalWorkspace& ws = localWorkspace();
+		long long allocationsBefore = threadAllocations(), evaluationsBefore = ws.evaluations;
+		this->poolEvaluations = this->poolAllocations = 0;
+		double publishedCost = numeric_limits<double>::max();
 		//return this->bestFeasibleSol;
 		for (i = 0; i < MAX_ITERATIONS; i++) {
 
@@ -18,6 +36,12 @@ svrpSol TabuSearchSVRP::run(Graph inst, int numVehicles, int capacity) {
 			neighbourhoodSearch();
 			update();
 
+			// Publicar periodicamente a melhor solução viável no pool compartilhado
+			if (this->elitePool && this->itCount % ELITE_PERIOD == 0 && this->bestFeasibleSol.expectedCost < publishedCost) {
+				this->elitePool->publish(this->bestFeasibleSol);
+				publishedCost = this->bestFeasibleSol.expectedCost;
+			}
+
 			// Intensificar ou terminar
 			if (this->currNoImprovement >= this->maxNoImprovement) {
 
@@ -30,19 +54,21 @@ svrpSol TabuSearchSVRP::run(Graph inst, int numVehicles, int capacity) {
 					this->currNoImprovement = 0;
 					this->maxNoImprovement = 100;
 
+					if (this->elitePool)
+						pullElite();
+
 					if (!this->bestFeasibleSol.routes.empty()) {
 
 						if (verbosity == 'y')
 							cout << "Alguma solucao viavel foi encontrada com custo: " << this->bestFeasibleSol.expectedCost << endl;
 
 						this->sol = this->bestFeasibleSol;
+						syncEvaluators();
 
 						/* Recuperar rota dos clientes e numero de rotas */
 						this->numRoutes = 0;
 						for (unsigned int j = 0; j < this->sol.routes.size(); j++) {
-							for (unsigned int k = 0; k < this->sol.routes[j].size(); k++) {
-								routeOfClient[this->sol.routes[j][k]] = j;
-							}
+							indexRoute(j);
 							this->numRoutes++;
 						}
 					}
@@ -63,6 +89,12 @@ svrpSol TabuSearchSVRP::run(Graph inst, int numVehicles, int capacity) {
 
 		}
 
+		if (this->elitePool)
+			this->elitePool->publish(this->bestFeasibleSol);
+
+		this->searchAllocations = allocationsBefore < 0 ? -1 : threadAllocations() - allocationsBefore + this->poolAllocations;
+		this->searchEvaluations = ws.evaluations - evaluationsBefore + this->poolEvaluations;
+
 	}
 
 	else {
@@ -119,26 +151,27 @@ void TabuSearchSVRP::TwoOptSwap(int i, int j, int k) {
 	this->bestFeasibleSol.routes[i][k] = aux;
 }
 
-/* Etapa 1: construir solução e estruturas iniciais */
-void TabuSearchSVRP::initialize(Graph inst, int numVehicles, int capacity) {
+/*
+prepare: Calcula as estruturas da busca que dependem apenas da instância, os vizinhos
+mais próximos de cada vértice e a demanda relativa de cada cliente. Feito uma vez por
+instância (Graph::instanceId): buscas seguidas na mesma instância, com outras
+capacidades ou frotas, as reaproveitam.
+*/
+void TabuSearchSVRP::prepare(const Graph& inst) {
 
-	if (verbosity == 'y')
-		cout << endl << "INITIALIZE" << endl;
+	this->g = &inst;
+	this->preparedInstance = inst.instanceId;
 
-	this->g = inst;
-	this->numVehicles = numVehicles;
-	this->capacity = capacity;
-
-	int h = min(this->g.numberVertices - 1, 10);
+	int h = min(this->g->numberVertices - 1, 10);
 
 	this->closestNeighbours.clear();
-	vector<int> index(this->g.numberVertices - 1); // -1, pois não pegamos o depósito
+	vector<int> index(this->g->numberVertices - 1); // -1, pois não pegamos o depósito
 	iota(index.begin(), index.end(), 1); // Com 0 pegamos o depósito
 
 	// Computar os h vizinhos mais próximos de cada vértice
-	for (int i = 0; i < this->g.numberVertices; i++) {
+	for (int i = 0; i < this->g->numberVertices; i++) {
 
-		vector<double> dist = this->g.adjMatrix[i];
+		const vector<double>& dist = this->g->adjMatrix[i];
 		vector<int> closest = index;
 
 		sort(closest.begin(), closest.end(), [&dist](size_t i1, size_t i2) {
@@ -154,18 +187,90 @@ void TabuSearchSVRP::initialize(Graph inst, int numVehicles, int capacity) {
 
 	}
 
-	this->routeOfClient.resize(this->g.numberVertices);
+	if(verbosity == 'y')
+		cout << "Demandas relativas:" << endl;
+
+	// Coeficiente que relaciona a demanda esperada do vértice com a total
+	this->relativeDemand.clear();
+	for (int i = 1; i < this->g->numberVertices; i++) {
+
+		relativeDemand.push_back(this->g->vertices[i].demand.mean / this->g->totalExpectedDemand);
+
+		if (verbosity == 'y')
+			cout << relativeDemand[i - 1] << endl;
+
+	}
+}
+
+/* Etapa 1: construir solução e estruturas iniciais */
+void TabuSearchSVRP::initialize(const Graph& inst, int numVehicles, int capacity, const vector<vector<int>>& initialRoutes) {
+
+	if (verbosity == 'y')
+		cout << endl << "INITIALIZE" << endl;
+
+	if (this->preparedInstance != inst.instanceId)
+		prepare(inst);
+
+	this->g = &inst;
+	this->generator.seed(this->seed);
+	this->numVehicles = numVehicles;
+	this->capacity = capacity;
+
+	// Contadores de uma busca anterior com o mesmo objeto
+	this->screenedCandidates = this->exactCandidates = 0;
+	this->maxScreeningError = this->sumScreeningError = 0;
+	this->boundedCandidates = this->skippedEvaluations = 0;
+	this->reversedRoutes = 0;
+
+	// Pool persistente, reaproveitado entre iterações e buscas
+	int threads = this->numThreads > 0 ? this->numThreads : max(1u, thread::hardware_concurrency());
+	if (threads == 1)
+		this->pool.reset();
+	else if (!this->pool || this->pool->size() != threads)
+		this->pool = make_shared<WorkerPool>(threads);
+
+	this->routeOfClient.resize(this->g->numberVertices);
+	this->positionOfClient.resize(this->g->numberVertices);
 	this->sol.routes.clear();
 
+	// Rotas iniciais dadas, como a solução de uma busca anterior
+	if (!initialRoutes.empty()) {
+
+		for (unsigned int r = 0; r < initialRoutes.size(); r++) {
+
+			if (initialRoutes[r].empty())
+				continue;
+
+			this->sol.routes.push_back(initialRoutes[r]);
+			indexRoute(this->sol.routes.size() - 1);
+		}
+	}
+
 	// Rotas de ida e volta ao depósito
-	for (int i = 1; i < this->g.numberVertices; i++) {
+	else {
 
-		vector<int> route(1, i);
-		this->sol.routes.push_back(route);
-		this->routeOfClient[i] = i-1;
+		for (int i = 1; i < this->g->numberVertices; i++) {
+
+			vector<int> route(1, i);
+			this->sol.routes.push_back(route);
+			indexRoute(i - 1);
 
+		}
 	}
-	this->numRoutes = this->g.numberVertices - 1;
+	this->numRoutes = this->sol.routes.size();
+	reserveRoutes(this->sol);
+
+	// Nenhum movimento tabu, inclusive os de uma busca anterior com o mesmo objeto
+	this->tabuRoutes = this->sol.routes.size();
+	this->tabuExpiry.assign(this->g->numberVertices * this->tabuRoutes, 0);
+	this->sol.routeCosts.assign(this->sol.routes.size(), 0);
+	this->sol.routeVersions.assign(this->sol.routes.size(), 0);
+	for (unsigned int r = 0; r < this->sol.routes.size(); r++)
+		this->sol.routeVersions[r] = ++this->routeStamp;
+	this->routeEvaluators.clear();
+	this->routeEvaluators.resize(this->sol.routes.size());
+	this->evaluatorVersions.assign(this->sol.routes.size(), 0);
+	syncEvaluators();
 	/*this->numRoutes = this->numVehicles;
 	//Fetching number of clusters
 	int K = numVehicles;
@@ -174,8 +279,8 @@ void TabuSearchSVRP::initialize(Graph inst, int numVehicles, int capacity) {
 	int pointId = 1;
 	vector<Point> all_points;
 
-	for(int i = 0; i < g.numberVertices - 1; i++) {
-		Point point(pointId, g.vertices[i+1].x,g.vertices[i+1].y);
+	for(int i = 0; i < this->g->numberVertices - 1; i++) {
+		Point point(pointId, this->g->vertices[i+1].x,this->g->vertices[i+1].y);
 		all_points.push_back(point);
 		pointId++;
 	}
@@ -200,38 +305,27 @@ void TabuSearchSVRP::initialize(Graph inst, int numVehicles, int capacity) {
 
 	this->penalty = 1;
 
-	this->sol.expectedCost = penalizedExpectedLength(this->sol.routes);
+	this->sol.expectedCost = penalizedExpectedLength(routeChange(), this->numRoutes);
+	printPenalizedCost(this->sol.expectedCost);
 	this->bestPenalExpCost = this->sol.expectedCost;
 
-	if(verbosity == 'y')
-		cout << "Demandas relativas:" << endl;
-
-	// Coeficiente que relaciona a demanda esperada do vértice com a total
-	for (int i = 1; i < this->g.numberVertices; i++) {
-
-		relativeDemand.push_back(this->g.expectedDemand[i] / this->g.totalExpectedDemand);
-
-		if (verbosity == 'y')
-			cout << relativeDemand[i - 1] << endl;
-
-	}
-
 	// Ajuste de parâmetros
-	this->numNearest = min(this->g.numberVertices - 1, 5);
-	this->numSelected = min(this->g.numberVertices - 1, 5 * this->numVehicles);
+	this->numNearest = min(this->g->numberVertices - 1, 5);
+	this->numSelected = min(this->g->numberVertices - 1, 5 * this->numVehicles);
 
 	this->itCount = 0;
 	this->currNoImprovement = 0;
 
-	if (numVehicles < this->g.numberVertices - 1) {
+	if (numVehicles < this->numRoutes) {
 		this->numInfeasibleNearby = 1;
+		this->bestFeasibleSol.routes.clear();
 		this->bestFeasibleSol.expectedCost = numeric_limits<double>::max();
 	}
 	else {
 		this->numInfeasibleNearby = 0;
-		if (numVehicles == this->g.numberVertices - 1) {
-			this->bestFeasibleSol.expectedCost = this->sol.expectedCost;
-			this->bestFeasibleSol.routes = this->sol.routes;
+		if (numVehicles == this->numRoutes) {
+			this->bestFeasibleSol = this->sol;
+			reserveRoutes(this->bestFeasibleSol);
 		}
 		else {
 			this->bestFeasibleSol.routes.clear();
@@ -239,7 +333,18 @@ void TabuSearchSVRP::initialize(Graph inst, int numVehicles, int capacity) {
 		}
 	}
 
-	this->maxNoImprovement = 50 * this->g.numberVertices;
+	this->maxNoImprovement = 50 * this->g->numberVertices;
+
+	/* Buffers das iterações: numSelected movimentos, até numberVertices - 1 na
+	intensificação, dos quais no máximo 5 são candidatos avaliados juntos */
+	this->bestMoves.reserve(this->g->numberVertices - 1);
+	this->candidates.reserve(5);
+	this->selected.reserve(5);
+	this->finalistOrder.reserve(5);
+	this->finalist.reserve(5);
+	this->candidateCosts.reserve(5);
+	this->taskEvaluations.reserve(5);
+	this->taskAllocations.reserve(5);
 
 	if (verbosity == 'y')
 		cout << "END_INITIALIZE" << endl << endl;
@@ -252,27 +357,23 @@ void TabuSearchSVRP::neighbourhoodSearch() {
 	if (verbosity == 'y')
 		cout << "NEIGHBOURHOOD_SEARCH" << endl;
 
-	vector<routeMove> bestMoves;
+	vector<routeMove>& bestMoves = this->bestMoves;
+	bestMoves.clear();
 
 	this->itCount++;
 	this->currNoImprovement++;
 
-	vector<int> customers;
-	for (int i = 0; i < this->g.numberVertices - 1; i++) {
-		customers.push_back(i + 1);
-	}
-
 	// Considerar todos movimentos candidatos na vizinhança
 	for (int i = 0; i < this->numSelected; i++) {
 
 		routeMove newMove;
 
-		newMove.client = customers[rand() % (this->g.numberVertices - 1)];
+		newMove.client = 1 + this->generator() % (this->g->numberVertices - 1);
 		newMove.valid = true;
 		newMove.clientRoute = routeOfClient[newMove.client];
 
 		//Escolher um vizinho desse cliente aleatoriamente
-		int neighbourIdx = rand() % (this->numNearest - 1);
+		int neighbourIdx = this->generator() % (this->numNearest - 1);
 		do {
 			newMove.neighbour = this->closestNeighbours[newMove.client][neighbourIdx];
 		} while (newMove.neighbour == newMove.client);
@@ -288,7 +389,7 @@ void TabuSearchSVRP::neighbourhoodSearch() {
 		}
 
 		// Inserir na lista de movimentos em ordem não-decrescente
-		auto pos = find_if(bestMoves.begin(), bestMoves.end(), [newMove](routeMove m) {
+		auto pos = find_if(bestMoves.begin(), bestMoves.end(), [newMove](const routeMove& m) {
 			return m.approxCost > newMove.approxCost;
 			});
 
@@ -315,10 +416,18 @@ void TabuSearchSVRP::neighbourhoodSearch() {
 	int numTabuMoves = 0;
 	routeMove bestMoveNotTabu;
 	double bestMovePenalExpCost = numeric_limits<double>::max(), bestMoveNotTabuPenalExpCost = numeric_limits<double>::max();
-	vector<vector<int>> bestRoutes, bestNotTabuRoutes;
+	routeChange change, bestChange, bestNotTabuChange;
 	this->moveDone.valid = false;
 	bestMoveNotTabu.valid = false;
 
+	// Triagem pela aproximação normal (numFinalists > 0)
+	bool screening = this->numFinalists > 0;
+	vector<screenedMove>& candidates = this->candidates;
+	candidates.clear();
+
+	// Com o pool de threads, os candidatos são avaliados exatamente após o laço, todos juntos
+	bool parallel = !screening && this->pool;
+
 	for (int i = 0; i < min(5, (int)bestMoves.size()); i++) {
 
 		routeMove currMove = bestMoves[i];
@@ -327,157 +436,124 @@ void TabuSearchSVRP::neighbourhoodSearch() {
 			cout << "Analisando movimento " << i << ": " << currMove.client << " " << currMove.neighbour << endl;
 
 		// Checar se é um movimento tabu
-		auto tabuPos = find_if(tabuMoves.begin(), tabuMoves.end(), [currMove](routeMove m) {
-			return m == currMove;
-			});
-
-		bool notTabu = (tabuPos == tabuMoves.end());
-
-		vector<vector<int>> actualSol = this->sol.routes;
-		double movePenalExpCost;
-
-		if (routeOfClient[currMove.client] == routeOfClient[currMove.neighbour]) {
-
-			vector<int> sameRoute = actualSol[routeOfClient[currMove.client]];
-
-			if (verbosity == 'y') {
-				cout << "Rota de ambos antes da troca: ";
-				for (unsigned int j = 0; j < sameRoute.size(); j++)
-					cout << sameRoute[j] << " ";
-				cout << endl;
-			}
-
-			int clientPos, neighbourPos;
-			for (unsigned int j = 0; j < sameRoute.size(); j++) {
-				if (sameRoute[j] == currMove.client) {
-					clientPos = j;
-				}
-				else if (sameRoute[j] == currMove.neighbour) {
-					neighbourPos = j;
-				}
-			}
+		bool notTabu = !isTabu(currMove);
 
-			if (clientPos < neighbourPos) {
-				sameRoute.erase(remove(sameRoute.begin(), sameRoute.end(), currMove.client));
-				if (neighbourPos > 0)
-					sameRoute.insert(sameRoute.begin() + neighbourPos - 1, currMove.client);
-				else
-					sameRoute.insert(sameRoute.begin(), currMove.client);
-			}
-			else {
-				sameRoute.erase(remove(sameRoute.begin(), sameRoute.end(), currMove.client));
-				sameRoute.insert(sameRoute.begin() + neighbourPos, currMove.client);
-			}
+		describeMove(currMove, change);
 
-			if (verbosity == 'y')
-				cout << "Rota de ambos apos a troca: ";
+		// Com triagem ou em paralelo, apenas guardar o candidato; eles são avaliados a seguir
+		if (screening || parallel) {
+			candidates.push_back(screenedMove(currMove, change, notTabu,
+				screening ? approximateChange(change, routesAfter(change)) : 0));
+			if (screening)
+				printPenalizedCost(candidates.back().approxCost);
+			continue;
+		}
 
-			for (unsigned int j = 0; j < sameRoute.size(); j++) {
+		// Computar custo esperado e armazenar a melhor solução encontrada
+		double movePenalExpCost = evaluateBounded(change, notTabu ? bestMoveNotTabuPenalExpCost : bestMovePenalExpCost, routesAfter(change));
+		if (movePenalExpCost < numeric_limits<double>::max())
+			printPenalizedCost(movePenalExpCost);
 
-				if (verbosity == 'y')
-					cout << sameRoute[j] << " ";
+		if (movePenalExpCost < bestMovePenalExpCost) {
+			bestMovePenalExpCost = movePenalExpCost;
+			bestChange = change;
+			this->moveDone = currMove;
+		}
 
+		if (notTabu) {
+			if (movePenalExpCost < bestMoveNotTabuPenalExpCost) {
+				bestMoveNotTabuPenalExpCost = movePenalExpCost;
+				bestNotTabuChange = change;
+				bestMoveNotTabu = currMove;
 			}
-
-			if (verbosity == 'y')
-				cout << endl;
-
-			actualSol[routeOfClient[currMove.client]] = sameRoute;
-
-			// Computar custo esperado e armazenar a melhor solução encontrada
-			movePenalExpCost = penalizedExpectedLength(actualSol);
 		}
+	}
 
-		else {
-
-			vector<int> clientRoute = actualSol[routeOfClient[currMove.client]];
-			vector<int> neighbourRoute = actualSol[routeOfClient[currMove.neighbour]];
-
-			int neighbour = currMove.neighbour;
-			auto neighbourPos = find_if(neighbourRoute.begin(), neighbourRoute.end(), [neighbour](int x) {
-				return x == neighbour;
-				});
+	// Redução na ordem dos candidatos, como no laço sequencial
+	if (parallel) {
 
-			if (verbosity == 'y')
-				cout << "Rota do vizinho antes de ser adicionado: ";
+		const vector<double>& costs = this->candidateCosts;
+		this->selected.resize(candidates.size());
+		iota(this->selected.begin(), this->selected.end(), 0);
+		evaluateCandidates();
 
-			for (unsigned int j = 0; j < neighbourRoute.size(); j++) {
+		for (unsigned int k = 0; k < candidates.size(); k++) {
 
-				if (verbosity == 'y')
-					cout << neighbourRoute[j] << " ";
+			printPenalizedCost(costs[k]);
 
+			if (costs[k] < bestMovePenalExpCost) {
+				bestMovePenalExpCost = costs[k];
+				bestChange = candidates[k].change;
+				this->moveDone = candidates[k].move;
 			}
 
-			if (verbosity == 'y')
-				cout << endl;
-
-			neighbourRoute.insert(neighbourPos, currMove.client);
-
-			if (verbosity == 'y')
-				cout << "Rota do vizinho apos ser adicionado: ";
-
-			for (unsigned int j = 0; j < neighbourRoute.size(); j++) {
-
-				if (verbosity == 'y')
-					cout << neighbourRoute[j] << " ";
-
+			if (candidates[k].notTabu && costs[k] < bestMoveNotTabuPenalExpCost) {
+				bestMoveNotTabuPenalExpCost = costs[k];
+				bestNotTabuChange = candidates[k].change;
+				bestMoveNotTabu = candidates[k].move;
 			}
+		}
+	}
 
-			if (verbosity == 'y') { cout << endl; }
-
-			if (verbosity == 'y')
-				cout << "Rota do cliente antes de ser removido: ";
-
-			for (unsigned int j = 0; j < clientRoute.size(); j++) {
+	/* Avaliar exatamente os finalistas da triagem: os numFinalists melhores pela
+	aproximação e os numFinalists melhores não tabu, na ordem original */
+	if (screening) {
+
+		// Ordem estável pelo custo aproximado; sort, ao contrário de stable_sort, não aloca
+		vector<int>& order = this->finalistOrder;
+		order.resize(candidates.size());
+		iota(order.begin(), order.end(), 0);
+		sort(order.begin(), order.end(), [&candidates](int a, int b) {
+			return candidates[a].approxCost < candidates[b].approxCost
+				|| (candidates[a].approxCost == candidates[b].approxCost && a < b);
+			});
 
-				if (verbosity == 'y')
-					cout << clientRoute[j] << " ";
+		vector<bool>& finalist = this->finalist;
+		finalist.assign(candidates.size(), false);
+		int numBest = 0, numNotTabu = 0;
 
+		for (unsigned int k = 0; k < order.size(); k++) {
+			if (numBest < this->numFinalists) {
+				finalist[order[k]] = true;
+				numBest++;
 			}
-
-			if (verbosity == 'y')
-				cout << endl;
-
-			// Remover cliente da sua rota e inserir na rota vizinha
-			clientRoute.erase(remove(clientRoute.begin(), clientRoute.end(), currMove.client));
-
-			if (verbosity == 'y')
-				cout << "Rota do cliente apos ser removido: ";
-
-			for (unsigned int j = 0; j < clientRoute.size(); j++) {
-
-				if (verbosity == 'y')
-					cout << clientRoute[j] << " ";
-
+			if (candidates[order[k]].notTabu && numNotTabu < this->numFinalists) {
+				finalist[order[k]] = true;
+				numNotTabu++;
 			}
+		}
 
-			if (verbosity == 'y')
-				cout << endl;
+		const vector<int>& selected = this->selected;
+		const vector<double>& costs = this->candidateCosts;
+		this->selected.clear();
+		for (unsigned int k = 0; k < candidates.size(); k++)
+			if (finalist[k])
+				this->selected.push_back(k);
 
-			if (clientRoute.empty())
-				this->numRoutes--;
+		evaluateCandidates();
+		this->screenedCandidates += candidates.size();
 
-			actualSol[routeOfClient[currMove.client]] = clientRoute;
-			actualSol[routeOfClient[currMove.neighbour]] = neighbourRoute;
+		for (unsigned int s = 0; s < selected.size(); s++) {
 
-			// Computar custo esperado e armazenar a melhor solução encontrada
-			movePenalExpCost = penalizedExpectedLength(actualSol);
+			screenedMove& candidate = candidates[selected[s]];
+			double movePenalExpCost = costs[s];
+			printPenalizedCost(movePenalExpCost);
 
-			if (clientRoute.empty())
-				this->numRoutes++;
-		}
+			double error = fabs(candidate.approxCost - movePenalExpCost) / movePenalExpCost;
+			this->exactCandidates++;
+			this->maxScreeningError = max(this->maxScreeningError, error);
+			this->sumScreeningError += error;
 
-		if (movePenalExpCost < bestMovePenalExpCost) {
-			bestMovePenalExpCost = movePenalExpCost;
-			bestRoutes = actualSol;
-			this->moveDone = currMove;
-		}
+			if (movePenalExpCost < bestMovePenalExpCost) {
+				bestMovePenalExpCost = movePenalExpCost;
+				bestChange = candidate.change;
+				this->moveDone = candidate.move;
+			}
 
-		if (notTabu) {
-			if (movePenalExpCost < bestMoveNotTabuPenalExpCost) {
+			if (candidate.notTabu && movePenalExpCost < bestMoveNotTabuPenalExpCost) {
 				bestMoveNotTabuPenalExpCost = movePenalExpCost;
-				bestNotTabuRoutes = actualSol;
-				bestMoveNotTabu = currMove;
+				bestNotTabuChange = candidate.change;
+				bestMoveNotTabu = candidate.move;
 			}
 		}
 	}
@@ -485,7 +561,7 @@ void TabuSearchSVRP::neighbourhoodSearch() {
 	/* Possível critério de aspiração */
 	if (bestMovePenalExpCost < sol.expectedCost) {
 		sol.expectedCost = bestMovePenalExpCost;
-		sol.routes = bestRoutes;
+		applyChange(bestChange);
 		return;
 	}
 
@@ -509,97 +585,20 @@ void TabuSearchSVRP::neighbourhoodSearch() {
 				cout << "Analisando movimento " << i << ": " << currMove.client << " " << currMove.neighbour << endl;
 
 			// Checar se é um movimento tabu
-			auto tabuPos = find_if(tabuMoves.begin(), tabuMoves.end(), [currMove](routeMove m) {
-				return m == currMove;
-				});
-
-			if (tabuPos != tabuMoves.end()) {
+			if (isTabu(currMove)) {
 				numTabuMoves++;
 				continue;
 			}
 
-			vector<vector<int>> actualSol = this->sol.routes;
-
-			vector<int> clientRoute = actualSol[routeOfClient[currMove.client]];
-			vector<int> neighbourRoute = actualSol[routeOfClient[currMove.neighbour]];
-
-			int neighbour = currMove.neighbour;
-			auto neighbourPos = find_if(neighbourRoute.begin(), neighbourRoute.end(), [neighbour](int x) {
-				return x == neighbour;
-				});
-
-			if (verbosity == 'y')
-				cout << "Rota do vizinho antes de ser adicionado: ";
-
-			for (unsigned int j = 0; j < neighbourRoute.size(); j++) {
-
-				if (verbosity == 'y')
-					cout << neighbourRoute[j] << " ";
-
-			}
-
-			if (verbosity == 'y')
-				cout << endl;
-
-			neighbourRoute.insert(neighbourPos, currMove.client);
-
-			if (verbosity == 'y')
-				cout << "Rota do vizinho apos ser adicionado: ";
-
-			for (unsigned int j = 0; j < neighbourRoute.size(); j++) {
-
-				if (verbosity == 'y')
-					cout << neighbourRoute[j] << " ";
-
-			}
-
-			if (verbosity == 'y')
-				cout << endl;
-
-			if (verbosity == 'y')
-				cout << "Rota do cliente antes de ser removido: ";
-
-			for (unsigned int j = 0; j < clientRoute.size(); j++) {
-
-				if (verbosity == 'y')
-					cout << clientRoute[j] << " ";
-
-			}
-
-			if (verbosity == 'y')
-				cout << endl;
-
-			// Remover cliente da sua rota e inserir na rota vizinha
-			clientRoute.erase(remove(clientRoute.begin(), clientRoute.end(), currMove.client));
-
-			if (verbosity == 'y')
-				cout << "Rota do cliente apos ser removido: ";
-
-			for (unsigned int j = 0; j < clientRoute.size(); j++) {
-
-				if (verbosity == 'y')
-					cout << clientRoute[j] << " ";
-
-			}
-
-			if (verbosity == 'y')
-				cout << endl;
-
-			if (clientRoute.empty())
-				this->numRoutes--;
-
-			actualSol[routeOfClient[currMove.client]] = clientRoute;
-			actualSol[routeOfClient[currMove.neighbour]] = neighbourRoute;
-
 			// Computar custo esperado e armazenar a melhor solução encontrada
-			double movePenalExpCost = penalizedExpectedLength(actualSol);
-
-			if (clientRoute.empty())
-				this->numRoutes++;
+			describeMove(currMove, change);
+			double movePenalExpCost = evaluateBounded(change, bestMoveNotTabuPenalExpCost, routesAfter(change));
+			if (movePenalExpCost < numeric_limits<double>::max())
+				printPenalizedCost(movePenalExpCost);
 
 			if (movePenalExpCost < bestMoveNotTabuPenalExpCost) {
 				bestMoveNotTabuPenalExpCost = movePenalExpCost;
-				bestNotTabuRoutes = actualSol;
+				bestNotTabuChange = change;
 				bestMoveNotTabu = currMove;
 			}
 		}
@@ -608,7 +607,7 @@ void TabuSearchSVRP::neighbourhoodSearch() {
 	this->moveDone = bestMoveNotTabu;
 	if (this->moveDone.valid) {
 		sol.expectedCost = bestMoveNotTabuPenalExpCost;
-		sol.routes = bestNotTabuRoutes;
+		applyChange(bestNotTabuChange);
 	}
 
 }
@@ -667,76 +666,342 @@ void TabuSearchSVRP::update() {
 
 				this->bestFeasibleSol.expectedCost = this->sol.expectedCost;
 				this->bestFeasibleSol = this->sol;
+				reserveRoutes(this->bestFeasibleSol);
 			}
 
 		}
 
-		routeOfClient[moveDone.client] = routeOfClient[moveDone.neighbour];
-		if (this->g.numberVertices > 5) {
-			this->moveDone.tabuDuration = this->itCount + (this->g.numberVertices - 5) + (rand() % 6);
+		if (this->g->numberVertices > 5) {
+			this->moveDone.tabuDuration = this->itCount + (this->g->numberVertices - 5) + (this->generator() % 6);
 		}
 		else {
-			this->moveDone.tabuDuration = this->itCount + (1) + (rand() % 6);
+			this->moveDone.tabuDuration = this->itCount + (1) + (this->generator() % 6);
 		}
 
 		// Inserir movimento realizado
-		this->tabuMoves.push_back(this->moveDone);
+		makeTabu(this->moveDone);
 	}
 
 	else if (verbosity == 'y')
 		cout << "Todos os movimentos sao tabu e nenhum melhora" << endl;
 
-	for (unsigned int i = 0; i < this->tabuMoves.size(); i++) {
+	// Atualizar penalidade
+	if (this->itCount % 10 == 0) {
+		this->penalty *= pow(2, this->numInfeasibleNearby / 5 - 1);
+		this->numInfeasibleNearby = 0;
+	}
 
-		// Remover da lista de movimentos tabus se ultrapassou duração
-		if (this->itCount >= tabuMoves[i].tabuDuration) {
+}
 
-			routeMove toBeErased = this->tabuMoves[i];
 
-			this->tabuMoves.erase(remove_if(this->tabuMoves.begin(), this->tabuMoves.end(), [toBeErased](routeMove m) {
-				return m == toBeErased;
-				}), this->tabuMoves.end());
+// Movimentos tabu são os iguais (routeMove::operator==) a um movimento que ainda não expirou
+bool TabuSearchSVRP::isTabu(const routeMove& m) const {
+	return this->itCount <= this->tabuExpiry[m.client * this->tabuRoutes + m.clientRoute];
+}
 
-		}
+/* Torna tabu o movimento "m" realizado nesta iteração, até m.tabuDuration. Um movimento
+igual ainda tabu expira antes, se for o caso: a expiração de um movimento remove da lista
+tabu todos os iguais a ele. */
+void TabuSearchSVRP::makeTabu(const routeMove& m) {
 
+	int& expiry = this->tabuExpiry[m.client * this->tabuRoutes + m.clientRoute];
+
+	if (expiry >= this->itCount)
+		expiry = min(expiry, m.tabuDuration);
+	else
+		expiry = m.tabuDuration;
+}
+
+/* Função objetivo com penalização de soluções inviáveis, para a solução atual com as
+rotas alteradas por "change", que deixam a solução com "numRoutes" rotas. Apenas a
+diferença de custo das rotas alteradas é considerada; as demais usam o custo cacheado
+em sol.routeCosts. */
+double TabuSearchSVRP::penalizedExpectedLength(const routeChange& change, int numRoutes) const {
+
+	double totalExpLength = this->sol.routesCost;
+
+	if (change.r1 >= 0)
+		totalExpLength += change.cost1 - this->sol.routeCosts[change.r1];
+	if (change.r2 >= 0)
+		totalExpLength += change.cost2 - this->sol.routeCosts[change.r2];
+
+	return totalExpLength + penalty * abs(numRoutes - numVehicles);
+}
+
+/* Preenche os custos exatos das rotas de "change", pelos avaliadores incrementais, e
+retorna o custo penalizado da solução. */
+double TabuSearchSVRP::evaluateChange(routeChange& change, int numRoutes) const {
+
+	if (change.r2 >= 0) {
+		change.cost1 = this->routeEvaluators[change.r1].costWithRemove(change.from);
+		change.cost2 = this->routeEvaluators[change.r2].costWithInsert(change.to, change.client);
+	}
+	else {
+		change.cost1 = this->routeEvaluators[change.r1].costWithMove(change.from, change.to);
 	}
 
-	// Atualizar penalidade
-	if (this->itCount % 10 == 0) {
-		this->penalty *= pow(2, this->numInfeasibleNearby / 5 - 1);
-		this->numInfeasibleNearby = 0;
+	return penalizedExpectedLength(change, numRoutes);
+}
+
+/* Como evaluateChange, mas com o custo de cada rota alterada igual ao custo exato atual
+somado à diferença entre as aproximações normais da nova rota e da atual
+(approxRouteExpectedLength). O movimento é aplicado às rotas de "sol" para calcular as
+aproximações e desfeito em seguida. */
+double TabuSearchSVRP::approximateChange(routeChange& change, int numRoutes) {
+
+	double before1 = approxRouteExpectedLength(*this->g, this->capacity, this->sol.routes[change.r1]), before2 = 0;
+	if (change.r2 >= 0)
+		before2 = approxRouteExpectedLength(*this->g, this->capacity, this->sol.routes[change.r2]);
+
+	change.apply(this->sol.routes);
+
+	change.cost1 = this->sol.routeCosts[change.r1] + approxRouteExpectedLength(*this->g, this->capacity, this->sol.routes[change.r1]) - before1;
+	if (change.r2 >= 0)
+		change.cost2 = this->sol.routeCosts[change.r2] + approxRouteExpectedLength(*this->g, this->capacity, this->sol.routes[change.r2]) - before2;
+
+	change.undo(this->sol.routes);
+
+	return penalizedExpectedLength(change, numRoutes);
+}
+
+/* Como evaluateChange exato, mas desistindo do movimento assim que um limitante inferior
+do seu custo penalizado atinge "threshold", o custo a ser superado; nesse caso retorna
+infinito. O limitante é o custo a priori da rota que recebe o cliente somado às falhas
+das paradas já avaliadas (RouteEvaluator::boundedCostWithRoute); a rota de onde o
+cliente sai, se outra, é avaliada exatamente antes. */
+double TabuSearchSVRP::evaluateBounded(routeChange& change, double threshold, int numRoutes) {
+
+	if (!this->lowerBounds || threshold == numeric_limits<double>::max())
+		return evaluateChange(change, numRoutes);
+
+	this->boundedCandidates++;
+
+	// Custo penalizado da solução sem as rotas alteradas
+	double others = this->sol.routesCost - this->sol.routeCosts[change.r1] + penalty * abs(numRoutes - numVehicles);
+	bool complete;
+
+	if (change.r2 >= 0) {
+		others -= this->sol.routeCosts[change.r2];
+		change.cost1 = this->routeEvaluators[change.r1].costWithRemove(change.from);
+		change.cost2 = this->routeEvaluators[change.r2].boundedCostWithInsert(change.to, change.client, threshold - others - change.cost1, complete);
 	}
+	else {
+		change.cost1 = this->routeEvaluators[change.r1].boundedCostWithMove(change.from, change.to, threshold - others, complete);
+	}
+
+	if (!complete) {
+		this->skippedEvaluations++;
+		return numeric_limits<double>::max();
+	}
+
+	return penalizedExpectedLength(change, numRoutes);
+}
 
+// Número de rotas da solução atual após "change", que esvazia a rota r1 ao mover seu último cliente
+int TabuSearchSVRP::routesAfter(const routeChange& change) const {
+	return this->numRoutes - ((change.r2 >= 0 && this->sol.routes[change.r1].size() == 1) ? 1 : 0);
 }
 
+/* Descreve em "change" o movimento "m", que leva o cliente para imediatamente antes do
+vizinho, pelas posições de routeOfClient e positionOfClient */
+void TabuSearchSVRP::describeMove(const routeMove& m, routeChange& change) const {
 
-// Função objetivo com penalização de soluções inviáveis
-double TabuSearchSVRP::penalizedExpectedLength(vector<vector<int>> sol) {
+	int rc = this->routeOfClient[m.client], rn = this->routeOfClient[m.neighbour];
+	int clientPos = this->positionOfClient[m.client], neighbourPos = this->positionOfClient[m.neighbour];
 
-	double aux = totalExpectedLength(g, capacity, sol) + penalty * abs(this->numRoutes - numVehicles);
+	// Na mesma rota, a posição do vizinho diminui se o cliente estava antes dele
+	if (rc == rn)
+		change.set(rc, m.client, clientPos, clientPos < neighbourPos ? neighbourPos - 1 : neighbourPos);
+	else
+		change.set(rc, m.client, clientPos, rn, neighbourPos);
 
 	if (verbosity == 'y')
-		cout << "Custo penalizado total: " << aux << endl;
+		cout << "Cliente " << m.client << " da posicao " << change.from << " da rota " << change.r1 << " para a posicao "
+			<< change.to << " da rota " << (change.r2 >= 0 ? change.r2 : change.r1) << endl;
+}
+
+// Atualiza routeOfClient e positionOfClient para os clientes da rota r de "sol"
+void TabuSearchSVRP::indexRoute(int r) {
+
+	const vector<int>& route = this->sol.routes[r];
 
-	return aux;
+	for (unsigned int j = 0; j < route.size(); j++) {
+		this->routeOfClient[route[j]] = r;
+		this->positionOfClient[route[j]] = j;
+	}
 }
 
-// Custo de remover o cliente r da rota r
-double TabuSearchSVRP::removalCost(int r, int client) {
+/* Avalia exatamente os candidatos candidates[selected[s]], guardando o custo penalizado
+em candidateCosts[s]. Com o pool de threads, as avaliações são distribuídas entre as
+threads: cada uma escreve apenas no seu candidato e nas suas posições de candidateCosts,
+taskEvaluations e taskAllocations, e os avaliadores das rotas não são alterados, então o
+resultado é o mesmo da avaliação sequencial. A tarefa captura apenas "this" e o
+workspace da busca, para caber no std::function sem alocar. */
+void TabuSearchSVRP::evaluateCandidates() {
+
+	int numSelected = this->selected.size();
+	this->candidateCosts.resize(numSelected);
+	this->taskEvaluations.assign(numSelected, 0);
+	this->taskAllocations.assign(numSelected, 0);
+	const EvalWorkspace* searchWorkspace = &localWorkspace();
+
+	auto evaluate = [this, searchWorkspace](int s) {
+		EvalWorkspace& ws = localWorkspace();
+		long long evaluationsBefore = ws.evaluations, allocationsBefore = threadAllocations();
+
+		routeChange& change = this->candidates[this->selected[s]].change;
+		this->candidateCosts[s] = evaluateChange(change, routesAfter(change));
+
+		// As avaliações e alocações da thread da busca já são contadas por ela
+		if (&ws != searchWorkspace) {
+			this->taskEvaluations[s] = ws.evaluations - evaluationsBefore;
+			this->taskAllocations[s] = threadAllocations() - allocationsBefore;
+		}
+	};
+
+	if (this->pool)
+		this->pool->run(numSelected, evaluate);
+	else
+		for (int s = 0; s < numSelected; s++)
+			evaluate(s);
+
+	for (int s = 0; s < numSelected; s++) {
+		this->poolEvaluations += this->taskEvaluations[s];
+		this->poolAllocations += this->taskAllocations[s];
+	}
+}
+
+/* Aplica "change" à solução atual, no lugar, marcando as rotas alteradas com uma nova
+versão. Com orientRoutes, cada rota alterada é mantida no sentido mais barato
+(orientRoute) e o custo da solução é corrigido pela diferença. */
+void TabuSearchSVRP::applyChange(const routeChange& change) {
+
+	double predictedCost = this->sol.routesCost;
+	bool reversed = false;
+
+	change.apply(this->sol.routes);
 
-	vector<vector<double>> f = probTotalDemand(g, sol.routes[r]);
-	double before = routeExpectedLength(g, f, capacity, sol.routes[r]);
+	predictedCost += change.cost1 - this->sol.routeCosts[change.r1];
+	this->sol.routeVersions[change.r1] = ++this->routeStamp;
+	if (this->orientRoutes)
+		reversed |= orientRoute(change.r1);
 
-	vector<int> newRoute;
-	for (unsigned int i = 0; i < sol.routes[r].size(); i++) {
-		if (sol.routes[r][i] != client)
-			newRoute.push_back(sol.routes[r][i]);
+	if (change.r2 >= 0) {
+		predictedCost += change.cost2 - this->sol.routeCosts[change.r2];
+		this->sol.routeVersions[change.r2] = ++this->routeStamp;
+		if (this->orientRoutes)
+			reversed |= orientRoute(change.r2);
 	}
 
-	f = probTotalDemand(g, newRoute);
-	double after = routeExpectedLength(g, f, capacity, newRoute);
+	syncEvaluators();
 
-	return before - after;
+	indexRoute(change.r1);
+	if (change.r2 >= 0)
+		indexRoute(change.r2);
+
+	if (reversed)
+		this->sol.expectedCost += this->sol.routesCost - predictedCost;
+}
+
+/* Inverte a rota r de "sol" se percorrê-la no sentido inverso for mais barato, com os
+dois custos calculados juntos por routeExpectedLengthBothWays. A margem relativa evita
+inverter rotas cujos custos diferem apenas por arredondamento. */
+bool TabuSearchSVRP::orientRoute(int r) {
+
+	vector<int>& route = this->sol.routes[r];
+
+	if (route.size() < 2)
+		return false;
+
+	double reverseCost, forwardCost = routeExpectedLengthBothWays(*this->g, this->capacity, route, reverseCost);
+
+	if (reverseCost >= forwardCost * (1 - 1e-12))
+		return false;
+
+	reverse(route.begin(), route.end());
+	this->sol.routeVersions[r] = ++this->routeStamp;
+	this->reversedRoutes++;
+
+	return true;
+}
+
+/* Publica bestFeasibleSol no pool e, se a melhor solução do pool for melhor, a torna
+bestFeasibleSol, de onde a intensificação parte. As rotas não vazias da solução do pool
+são dispostas nas primeiras posições das rotas de "sol", com seus custos (mesma instância
+e capacidade) e versões novas, já que as versões de outra busca não valem nesta. */
+void TabuSearchSVRP::pullElite() {
+
+	const svrpSol& elite = this->eliteSol;
+	this->elitePool->publish(this->bestFeasibleSol);
+
+	if (!this->elitePool->best(this->eliteSol) || elite.expectedCost >= this->bestFeasibleSol.expectedCost)
+		return;
+
+	unsigned int numRoutes = 0;
+	for (unsigned int j = 0; j < elite.routes.size(); j++)
+		if (!elite.routes[j].empty())
+			numRoutes++;
+
+	if (numRoutes > this->sol.routes.size())
+		return;
+
+	svrpSol& best = this->bestFeasibleSol;
+	best.routes.resize(this->sol.routes.size());
+	reserveRoutes(best);
+	best.routeCosts.assign(best.routes.size(), 0);
+	best.routeVersions.resize(best.routes.size());
+	best.routesCost = 0;
+	best.expectedCost = elite.expectedCost;
+	unsigned int r = 0;
+
+	for (unsigned int j = 0; j < elite.routes.size(); j++) {
+
+		if (elite.routes[j].empty())
+			continue;
+
+		best.routes[r] = elite.routes[j];
+		best.routeCosts[r] = elite.routeCosts[j];
+		best.routesCost += best.routeCosts[r];
+		r++;
+	}
+
+	for (; r < best.routes.size(); r++)
+		best.routes[r].clear();
+
+	for (unsigned int j = 0; j < best.routes.size(); j++)
+		best.routeVersions[j] = ++this->routeStamp;
+}
+
+/* Reavaliar apenas as rotas de "sol" cuja versão difere da avaliada, atualizando os
+custos cacheados da solução */
+void TabuSearchSVRP::syncEvaluators() {
+
+	this->sol.routesCost = 0;
+
+	for (unsigned int r = 0; r < this->sol.routes.size(); r++) {
+
+		if (this->evaluatorVersions[r] != this->sol.routeVersions[r]) {
+			this->routeEvaluators[r].assign(this->g, this->capacity, this->sol.routes[r]);
+			this->evaluatorVersions[r] = this->sol.routeVersions[r];
+		}
+
+		this->sol.routeCosts[r] = this->routeEvaluators[r].expectedLength();
+		this->sol.routesCost += this->sol.routeCosts[r];
+	}
+}
+
+/* Reserva em cada rota de "s" espaço para todos os clientes, de forma que os movimentos
+e as cópias entre soluções não realoquem as rotas */
+void TabuSearchSVRP::reserveRoutes(svrpSol& s) {
+
+	for (unsigned int r = 0; r < s.routes.size(); r++)
+		s.routes[r].reserve(this->g->numberVertices - 1);
+}
+
+// Custo de remover o cliente r da rota r
+double TabuSearchSVRP::removalCost(int r, int client) {
+
+	return this->routeEvaluators[r].expectedLength() - this->routeEvaluators[r].costWithRemove(this->positionOfClient[client]);
 
 }
 
@@ -746,9 +1011,9 @@ double TabuSearchSVRP::maxRemovalCost(int r) {
 
 	double max = 0, aux = 0;
 
-	for (unsigned int i = 0; i < sol.routes[r].size(); i++) {
+	for (int i = 0; i < this->routeEvaluators[r].size(); i++) {
 
-		aux = removalCost(r, sol.routes[r][i]);
+		aux = this->routeEvaluators[r].expectedLength() - this->routeEvaluators[r].costWithRemove(i);
 
 		if (aux > max)
 			max = aux;
@@ -761,46 +1026,23 @@ double TabuSearchSVRP::maxRemovalCost(int r) {
 
 // Impacto aproximado de introdução do cliente b na rota
 double TabuSearchSVRP::approxInsertImpact(int a, int b, int c) {
-	return (g.adjMatrix[a][b] + g.adjMatrix[b][c] - g.adjMatrix[a][c]) * g.vertices[b].probOfPresence;
+	return (this->g->adjMatrix[a][b] + this->g->adjMatrix[b][c] - this->g->adjMatrix[a][c]) * this->g->vertices[b].probOfPresence;
 }
 
 /* Custo aproximado do movimento de remover o cliente de uma rota e
 inserí-lo imediatamente antes a um vizinho. */
-double TabuSearchSVRP::approxMoveCost(routeMove m) {
+double TabuSearchSVRP::approxMoveCost(const routeMove& m) {
 
 	double approxCost = 0;
-	int beforeClient = 0, beforeNeighbour = 0, afterClient = 0;
-
-	/*if(sol.routes[routeOfClient[m.client]].size() == 2 && sol.routes[routeOfClient[m.client]][0])
-		afterClient = sol.routes[routeOfClient[m.client]][1];*/
-	if (sol.routes[routeOfClient[m.client]].size() >= 2 && sol.routes[routeOfClient[m.client]][0] == m.client) {
-		afterClient = sol.routes[routeOfClient[m.client]][1];
-	}
-
-	else if (sol.routes[routeOfClient[m.client]].size() >= 2) {
-
-		for (unsigned int i = 1; i < sol.routes[routeOfClient[m.client]].size(); i++) {
-
-			if (sol.routes[routeOfClient[m.client]][i] == m.client) {
 
-				beforeClient = sol.routes[routeOfClient[m.client]][i - 1];
+	// Vizinhos de rota pelo índice de posições (0 = depósito)
+	const vector<int>& clientRoute = sol.routes[routeOfClient[m.client]];
+	const vector<int>& neighbourRoute = sol.routes[routeOfClient[m.neighbour]];
+	int clientPos = positionOfClient[m.client], neighbourPos = positionOfClient[m.neighbour];
 
-				//if(sol.routes[routeOfClient[m.client]].size() > i)
-				if (i < sol.routes[routeOfClient[m.client]].size() - 1)
-					afterClient = sol.routes[routeOfClient[m.client]][i + 1];
-				else
-					afterClient = 0;
-
-			}
-		}
-	}
-
-	for (unsigned int i = 1; i < sol.routes[routeOfClient[m.neighbour]].size(); i++) {
-
-		if (sol.routes[routeOfClient[m.neighbour]][i] == m.neighbour)
-			beforeNeighbour = sol.routes[routeOfClient[m.neighbour]][i - 1];
-
-	}
+	int beforeClient = clientPos > 0 ? clientRoute[clientPos - 1] : 0;
+	int afterClient = clientPos + 1 < (int)clientRoute.size() ? clientRoute[clientPos + 1] : 0;
+	int beforeNeighbour = neighbourPos > 0 ? neighbourRoute[neighbourPos - 1] : 0;
 
 	if (verbosity == 'y') {
 		cout << "Custo Aproximado:" << endl;
@@ -0,0 +1,90 @@
+#include "WorkerPool.h"
+
+// Número de verificações da geração antes de uma thread ociosa dormir
+#define WORKER_SPIN 20000
+
+WorkerPool::WorkerPool(int numThreads) : next(0), generation(0) {
+
+	this->task = NULL;
+	this->numTasks = 0;
+	this->active = 0;
+	this->stopping = false;
+
+	if (numThreads <= 0)
+		numThreads = max(1u, thread::hardware_concurrency());
+
+	for (int t = 1; t < numThreads; t++)
+		this->workers.push_back(thread(&WorkerPool::work, this));
+}
+
+WorkerPool::~WorkerPool() {
+
+	{
+		lock_guard<mutex> guard(this->lock);
+		this->stopping = true;
+		this->generation++;
+	}
+	this->wake.notify_all();
+
+	for (unsigned int t = 0; t < this->workers.size(); t++)
+		this->workers[t].join();
+}
+
+void WorkerPool::run(int numTasks, const function<void(int)>& task) {
+
+	if (this->workers.empty() || numTasks <= 1) {
+		for (int k = 0; k < numTasks; k++)
+			task(k);
+		return;
+	}
+
+	{
+		lock_guard<mutex> guard(this->lock);
+		this->task = &task;
+		this->numTasks = numTasks;
+		this->next = 0;
+		this->active = this->workers.size();
+		this->generation++;
+	}
+	this->wake.notify_all();
+
+	drain();
+
+	unique_lock<mutex> guard(this->lock);
+	this->finished.wait(guard, [this]() { return this->active == 0; });
+	this->task = NULL;
+}
+
+// Executa tarefas do lote atual até que não restem tarefas a iniciar
+void WorkerPool::drain() {
+
+	for (int k = this->next++; k < this->numTasks; k = this->next++)
+		(*this->task)(k);
+}
+
+/* Laço das threads do pool. Entre lotes próximos, como as iterações da busca, a thread
+apenas verifica a geração por algum tempo antes de dormir, evitando o custo de acordá-la. */
+void WorkerPool::work() {
+
+	unsigned long seen = 0;
+
+	while (true) {
+
+		for (int spin = 0; spin < WORKER_SPIN && this->generation.load() == seen; spin++)
+			this_thread::yield();
+
+		unique_lock<mutex> guard(this->lock);
+		this->wake.wait(guard, [this, seen]() { return this->generation.load() != seen; });
+		seen = this->generation.load();
+
+		if (this->stopping)
+			return;
+
+		guard.unlock();
+		drain();
+		guard.lock();
+
+		if (--this->active == 0)
+			this->finished.notify_one();
+	}
+}
@@ -0,0 +1,13 @@
+#include <cstdlib>
+#include "CheckSVRP.h"
+
+char verbosity = 'n';
+
+/* Executável do alvo "make check": compara as implementações do custo esperado em
+"numTrials" rotas aleatórias (padrão 200), sem a busca nem o modelo L-shaped. */
+int main(int argc, const char** argv) {
+
+	int numTrials = (argc >= 2) ? atoi(argv[1]) : 200;
+
+	return checkExpectedLength(numTrials, 1) == 0 ? 0 : 1;
+}
@@ -0,0 +1,662 @@
+#include <chrono>
+#include "convolution.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CONV_X86
+#include <immintrin.h>
+#endif
+
+/* Menor largura de suporte não uniforme convolucionada por FFT, por conjunto de
+instruções, medida com benchmarkConvolution */
+#ifndef FFT_WIDTH_AVX512
+#define FFT_WIDTH_AVX512 384
+#endif
+#ifndef FFT_WIDTH_AVX2
+#define FFT_WIDTH_AVX2 256
+#endif
+#ifndef FFT_WIDTH_SCALAR
+#define FFT_WIDTH_SCALAR 32
+#endif
+
+void DemandRows::resize(int numRows, int length, int padding) {
+
+	int stride = padding + (length + CONV_BLOCK - 1) / CONV_BLOCK * CONV_BLOCK;
+
+	if (stride != this->stride || length != this->length || padding != this->padding) {
+		this->data.assign(numRows * stride, 0);
+		this->stride = stride;
+		this->length = length;
+		this->padding = padding;
+	}
+	else {
+		this->data.resize(numRows * stride, 0);
+	}
+
+	this->numRows = numRows;
+}
+
+int rowPadding(const Graph& g) {
+	return (g.demandLimit + 7) / 8 * 8;
+}
+
+/*
+demandKernel: Monta os coeficientes da convolução de "v" a partir da distribuição da sua
+demanda (vertex::demand). Demandas com probabilidade nula ficam fora do suporte, assim
+como em probTotalDemand.
+*/
+void demandKernel(const vertex& v, DemandKernel& kernel) {
+
+	const DemandDistribution& d = v.demand;
+
+	kernel.absent = 1 - d.presence;
+	kernel.weights = d.pmf.data();
+	kernel.minDemand = d.maxDemand > 0 ? d.minDemand : 1;
+	kernel.maxDemand = d.maxDemand;
+	kernel.uniform = d.uniform;
+
+	if (kernel.uniform)
+		kernel.uniformWeight = kernel.weights[kernel.minDemand];
+}
+
+void wrapRow(double* row, int length, int maxDemand) {
+	for (int k = 1; k <= min(maxDemand, length); k++)
+		row[-k] = row[length - k];
+}
+
+/*
+Kernels diretos, especializados na largura W = maxDemand - minDemand + 1 do suporte: os
+pesos são carregados uma vez por linha e o laço em k, de tamanho conhecido em compilação,
+é desenrolado. A ordem das somas é a mesma do laço de minDemand a maxDemand.
+*/
+template <int W>
+static void convolveRowScalar(const double* in, const DemandKernel& kernel, double* out, int length) {
+
+	const double* shifted = in - kernel.minDemand;
+	double w[W > 0 ? W : 1];
+
+	for (int k = 0; k < W; k++)
+		w[k] = kernel.weights[kernel.minDemand + k];
+
+	for (int r = 0; r < length; r++) {
+
+		double acc = kernel.absent * in[r];
+
+		for (int k = 0; k < W; k++)
+			acc += w[k] * shifted[r - k];
+
+		out[r] = acc;
+	}
+}
+
+/*
+convolveRowSliding: Convolução com demanda uniforme em [minDemand, maxDemand], mantendo
+a soma de in[r - maxDemand], ..., in[r - minDemand] ao longo da linha.
+*/
+static void convolveRowSliding(const double* in, const DemandKernel& kernel, double* out, int length) {
+
+	double window = 0;
+
+	for (int k = kernel.minDemand; k <= kernel.maxDemand; k++)
+		window += in[-k];
+
+	for (int r = 0; r < length; r++) {
+		out[r] = kernel.absent * in[r] + kernel.uniformWeight * window;
+		window += in[r + 1 - kernel.minDemand] - in[r - kernel.maxDemand];
+	}
+}
+
+// Kernel direto genérico, para suportes mais largos do que CONV_UNROLLED_WIDTH
+static void convolveRowWideScalar(const double* in, const DemandKernel& kernel, double* out, int length) {
+
+	const double* shifted = in - kernel.minDemand;
+	const double* w = kernel.weights + kernel.minDemand;
+	int width = kernel.maxDemand - kernel.minDemand + 1;
+
+	for (int r = 0; r < length; r++) {
+
+		double acc = kernel.absent * in[r];
+
+		for (int k = 0; k < width; k++)
+			acc += w[k] * shifted[r - k];
+
+		out[r] = acc;
+	}
+}
+
+#ifdef CONV_X86
+
+// Dois acumuladores de 4 posições por iteração; escreve até o próximo múltiplo de 8
+template <int W>
+__attribute__((target("avx2,fma")))
+static void convolveRowAvx2(const double* in, const DemandKernel& kernel, double* out, int length) {
+
+	const double* shifted = in - kernel.minDemand;
+	__m256d absent = _mm256_set1_pd(kernel.absent);
+	__m256d w[W > 0 ? W : 1];
+
+	for (int k = 0; k < W; k++)
+		w[k] = _mm256_set1_pd(kernel.weights[kernel.minDemand + k]);
+
+	for (int r = 0; r < length; r += 8) {
+
+		__m256d acc0 = _mm256_mul_pd(absent, _mm256_loadu_pd(in + r));
+		__m256d acc1 = _mm256_mul_pd(absent, _mm256_loadu_pd(in + r + 4));
+
+		for (int k = 0; k < W; k++) {
+			acc0 = _mm256_fmadd_pd(w[k], _mm256_loadu_pd(shifted + r - k), acc0);
+			acc1 = _mm256_fmadd_pd(w[k], _mm256_loadu_pd(shifted + r + 4 - k), acc1);
+		}
+
+		_mm256_storeu_pd(out + r, acc0);
+		_mm256_storeu_pd(out + r + 4, acc1);
+	}
+}
+
+// Dois acumuladores de 8 posições por iteração; escreve até o próximo múltiplo de 16
+template <int W>
+__attribute__((target("avx512f")))
+static void convolveRowAvx512(const double* in, const DemandKernel& kernel, double* out, int length) {
+
+	const double* shifted = in - kernel.minDemand;
+	__m512d absent = _mm512_set1_pd(kernel.absent);
+	__m512d w[W > 0 ? W : 1];
+
+	for (int k = 0; k < W; k++)
+		w[k] = _mm512_set1_pd(kernel.weights[kernel.minDemand + k]);
+
+	for (int r = 0; r < length; r += 16) {
+
+		__m512d acc0 = _mm512_mul_pd(absent, _mm512_loadu_pd(in + r));
+		__m512d acc1 = _mm512_mul_pd(absent, _mm512_loadu_pd(in + r + 8));
+
+		for (int k = 0; k < W; k++) {
+			acc0 = _mm512_fmadd_pd(w[k], _mm512_loadu_pd(shifted + r - k), acc0);
+			acc1 = _mm512_fmadd_pd(w[k], _mm512_loadu_pd(shifted + r + 8 - k), acc1);
+		}
+
+		_mm512_storeu_pd(out + r, acc0);
+		_mm512_storeu_pd(out + r + 8, acc1);
+	}
+}
+
+// Genérico: quatro acumuladores, com os pesos lidos a cada passo; escreve até o próximo múltiplo de 16
+__attribute__((target("avx2,fma")))
+static void convolveRowWideAvx2(const double* in, const DemandKernel& kernel, double* out, int length) {
+
+	const double* shifted = in - kernel.minDemand;
+	const double* weights = kernel.weights + kernel.minDemand;
+	int width = kernel.maxDemand - kernel.minDemand + 1;
+	__m256d absent = _mm256_set1_pd(kernel.absent);
+
+	for (int r = 0; r < length; r += 16) {
+
+		__m256d acc0 = _mm256_mul_pd(absent, _mm256_loadu_pd(in + r));
+		__m256d acc1 = _mm256_mul_pd(absent, _mm256_loadu_pd(in + r + 4));
+		__m256d acc2 = _mm256_mul_pd(absent, _mm256_loadu_pd(in + r + 8));
+		__m256d acc3 = _mm256_mul_pd(absent, _mm256_loadu_pd(in + r + 12));
+
+		for (int k = 0; k < width; k++) {
+			__m256d w = _mm256_broadcast_sd(weights + k);
+			acc0 = _mm256_fmadd_pd(w, _mm256_loadu_pd(shifted + r - k), acc0);
+			acc1 = _mm256_fmadd_pd(w, _mm256_loadu_pd(shifted + r + 4 - k), acc1);
+			acc2 = _mm256_fmadd_pd(w, _mm256_loadu_pd(shifted + r + 8 - k), acc2);
+			acc3 = _mm256_fmadd_pd(w, _mm256_loadu_pd(shifted + r + 12 - k), acc3);
+		}
+
+		_mm256_storeu_pd(out + r, acc0);
+		_mm256_storeu_pd(out + r + 4, acc1);
+		_mm256_storeu_pd(out + r + 8, acc2);
+		_mm256_storeu_pd(out + r + 12, acc3);
+	}
+}
+
+// Genérico: dois acumuladores, com os pesos lidos a cada passo; escreve até o próximo múltiplo de 16
+__attribute__((target("avx512f")))
+static void convolveRowWideAvx512(const double* in, const DemandKernel& kernel, double* out, int length) {
+
+	const double* shifted = in - kernel.minDemand;
+	const double* weights = kernel.weights + kernel.minDemand;
+	int width = kernel.maxDemand - kernel.minDemand + 1;
+	__m512d absent = _mm512_set1_pd(kernel.absent);
+
+	for (int r = 0; r < length; r += 16) {
+
+		__m512d acc0 = _mm512_mul_pd(absent, _mm512_loadu_pd(in + r));
+		__m512d acc1 = _mm512_mul_pd(absent, _mm512_loadu_pd(in + r + 8));
+
+		for (int k = 0; k < width; k++) {
+			__m512d w = _mm512_set1_pd(weights[k]);
+			acc0 = _mm512_fmadd_pd(w, _mm512_loadu_pd(shifted + r - k), acc0);
+			acc1 = _mm512_fmadd_pd(w, _mm512_loadu_pd(shifted + r + 8 - k), acc1);
+		}
+
+		_mm512_storeu_pd(out + r, acc0);
+		_mm512_storeu_pd(out + r + 8, acc1);
+	}
+}
+
+#endif
+
+/*
+Convolução por FFT em blocos (overlap-save), para suportes largos: com x[t] = in[t - maxDemand]
+e h[j] = weights[minDemand + j], out[r] = absent * in[r] + (x * h)[r + W - 1]. Cada
+transformada de tamanho N (potência de 2) produz N - W + 1 posições; como h é real, dois
+blocos consecutivos são transformados juntos, um na parte real e outro na imaginária.
+O trabalho por posição é O(log N), contra O(W) dos kernels diretos.
+
+A transformada direta (decimação na frequência) deixa o resultado na ordem de bits
+invertidos e a inversa (decimação no tempo) parte dessa ordem; como o produto é ponto a
+ponto, a permutação nunca é feita. Partes reais e imaginárias ficam em vetores separados,
+para que os laços das borboletas sejam vetorizados.
+*/
+
+/* fftPlan: Raízes da unidade de uma transformada de tamanho "size", com os buffers dos
+pesos e dos blocos. Um por tamanho e por thread (ver localFftPlan). */
+struct fftPlan {
+	int size = 0;
+	vector<double> rootRe, rootIm; // root[half + j] = exp(-pi i j / half), j < half
+	vector<double> weightRe, weightIm, blockRe, blockIm;
+};
+
+static fftPlan& localFftPlan(int logSize) {
+
+	static thread_local fftPlan plans[31];
+	fftPlan& plan = plans[logSize];
+
+	if (plan.size == 0) {
+
+		int size = 1 << logSize;
+		plan.rootRe.resize(size);
+		plan.rootIm.resize(size);
+		plan.weightRe.resize(size);
+		plan.weightIm.resize(size);
+		plan.blockRe.resize(size);
+		plan.blockIm.resize(size);
+
+		for (int half = 1; half < size; half *= 2) {
+			for (int j = 0; j < half; j++) {
+				plan.rootRe[half + j] = cos(M_PI * j / half);
+				plan.rootIm[half + j] = -sin(M_PI * j / half);
+			}
+		}
+
+		plan.size = size;
+	}
+
+	return plan;
+}
+
+// Transformada direta, no lugar, com o resultado na ordem de bits invertidos
+static void forwardFft(double* __restrict re, double* __restrict im, const fftPlan& plan) {
+
+	for (int half = plan.size / 2; half >= 1; half /= 2) {
+
+		const double* __restrict wr = &plan.rootRe[half];
+		const double* __restrict wi = &plan.rootIm[half];
+
+		for (int i = 0; i < plan.size; i += 2 * half) {
+
+			double* __restrict ar = re + i;
+			double* __restrict ai = im + i;
+			double* __restrict br = re + i + half;
+			double* __restrict bi = im + i + half;
+
+			for (int j = 0; j < half; j++) {
+				double dr = ar[j] - br[j], di = ai[j] - bi[j];
+				ar[j] += br[j];
+				ai[j] += bi[j];
+				br[j] = dr * wr[j] - di * wi[j];
+				bi[j] = dr * wi[j] + di * wr[j];
+			}
+		}
+	}
+}
+
+// Transformada inversa (sem o fator 1/size), no lugar, a partir da ordem de bits invertidos
+static void inverseFft(double* __restrict re, double* __restrict im, const fftPlan& plan) {
+
+	for (int half = 1; half < plan.size; half *= 2) {
+
+		const double* __restrict wr = &plan.rootRe[half];
+		const double* __restrict wi = &plan.rootIm[half];
+
+		for (int i = 0; i < plan.size; i += 2 * half) {
+
+			double* __restrict ar = re + i;
+			double* __restrict ai = im + i;
+			double* __restrict br = re + i + half;
+			double* __restrict bi = im + i + half;
+
+			// Produto pela raiz conjugada
+			for (int j = 0; j < half; j++) {
+				double tr = br[j] * wr[j] + bi[j] * wi[j];
+				double ti = bi[j] * wr[j] - br[j] * wi[j];
+				br[j] = ar[j] - tr;
+				bi[j] = ai[j] - ti;
+				ar[j] += tr;
+				ai[j] += ti;
+			}
+		}
+	}
+}
+
+static void convolveRowFft(const double* in, const DemandKernel& kernel, double* out, int length) {
+
+	int width = kernel.maxDemand - kernel.minDemand + 1;
+	int logSize = 1;
+
+	// Blocos de 8 vezes a largura do suporte (ao menos 256), ou um único bloco para linhas curtas
+	while ((1 << logSize) < length + width - 1 && (1 << logSize) < max(8 * width, 256))
+		logSize++;
+
+	fftPlan& plan = localFftPlan(logSize);
+	int size = plan.size, step = size - width + 1;
+	double* hr = plan.weightRe.data();
+	double* hi = plan.weightIm.data();
+	double* xr = plan.blockRe.data();
+	double* xi = plan.blockIm.data();
+
+	// Transformada dos pesos, já com o fator 1/size da inversa
+	for (int j = 0; j < size; j++) {
+		hr[j] = (j < width) ? kernel.weights[kernel.minDemand + j] / size : 0;
+		hi[j] = 0;
+	}
+	forwardFft(hr, hi, plan);
+
+	const double* base = in - kernel.maxDemand;
+	int extent = length + kernel.maxDemand; // base[t] válido para t < extent
+
+	for (int b = 0; b < length; b += 2 * step) {
+
+		for (int t = 0; t < size; t++) {
+			xr[t] = (b + t < extent) ? base[b + t] : 0;
+			xi[t] = (b + step + t < extent) ? base[b + step + t] : 0;
+		}
+
+		forwardFft(xr, xi, plan);
+		for (int t = 0; t < size; t++) {
+			double pr = xr[t] * hr[t] - xi[t] * hi[t];
+			xi[t] = xr[t] * hi[t] + xi[t] * hr[t];
+			xr[t] = pr;
+		}
+		inverseFft(xr, xi, plan);
+
+		for (int j = 0; j < step && b + j < length; j++)
+			out[b + j] = kernel.absent * in[b + j] + xr[width - 1 + j];
+		for (int j = 0; j < step && b + step + j < length; j++)
+			out[b + step + j] = kernel.absent * in[b + step + j] + xi[width - 1 + j];
+	}
+}
+
+typedef void (*convolveRowFn)(const double*, const DemandKernel&, double*, int);
+
+enum convolutionTarget { TARGET_SCALAR, TARGET_AVX2, TARGET_AVX512 };
+
+// Kernel direto de largura W para o conjunto de instruções "target"
+template <int W>
+static convolveRowFn widthKernel(convolutionTarget target) {
+
+#ifdef CONV_X86
+	if (target == TARGET_AVX512)
+		return convolveRowAvx512<W>;
+	if (target == TARGET_AVX2)
+		return convolveRowAvx2<W>;
+#endif
+
+	return convolveRowScalar<W>;
+}
+
+// Instancia os kernels de largura 0 a W e preenche table[0..W]
+template <int W>
+struct widthKernels {
+	static void fill(convolutionTarget target, convolveRowFn* table) {
+		table[W] = widthKernel<W>(target);
+		widthKernels<W - 1>::fill(target, table);
+	}
+};
+
+template <>
+struct widthKernels<-1> {
+	static void fill(convolutionTarget, convolveRowFn*) {}
+};
+
+// Kernel direto genérico para o conjunto de instruções "target"
+static convolveRowFn wideKernel(convolutionTarget target) {
+
+#ifdef CONV_X86
+	if (target == TARGET_AVX512)
+		return convolveRowWideAvx512;
+	if (target == TARGET_AVX2)
+		return convolveRowWideAvx2;
+#endif
+
+	return convolveRowWideScalar;
+}
+
+/* Escolhe o conjunto de instruções em tempo de execução de acordo com a CPU. "slidingWidth"
+é a menor largura de suporte uniforme a partir da qual a soma deslizante, limitada pela
+latência da soma acumulada, supera o kernel direto; "fftWidth", a menor largura de suporte
+não uniforme a partir da qual a FFT supera o kernel direto (ver benchmarkConvolution). */
+static convolutionTarget selectTarget(const char** name, int* slidingWidth, int* fftWidth) {
+
+#ifdef CONV_X86
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx512f")) {
+		*name = "avx512";
+		*slidingWidth = 17;
+		*fftWidth = FFT_WIDTH_AVX512;
+		return TARGET_AVX512;
+	}
+
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+		*name = "avx2";
+		*slidingWidth = 8;
+		*fftWidth = FFT_WIDTH_AVX2;
+		return TARGET_AVX2;
+	}
+#endif
+
+	*name = "scalar";
+	*slidingWidth = 3;
+	*fftWidth = FFT_WIDTH_SCALAR;
+	return TARGET_SCALAR;
+}
+
+static const char* selectedIsa = "scalar";
+static int slidingMinWidth = 3;
+static int fftMinWidth = FFT_WIDTH_SCALAR;
+
+/* Tabela dos kernels diretos do conjunto de instruções da CPU: os especializados, indexados
+pela largura do suporte (0 a CONV_UNROLLED_WIDTH), e o genérico */
+struct kernelTable {
+
+	convolveRowFn byWidth[CONV_UNROLLED_WIDTH + 1];
+	convolveRowFn wide;
+
+	kernelTable() {
+		convolutionTarget target = selectTarget(&selectedIsa, &slidingMinWidth, &fftMinWidth);
+		widthKernels<CONV_UNROLLED_WIDTH>::fill(target, this->byWidth);
+		this->wide = wideKernel(target);
+	}
+};
+
+static const kernelTable& selectedKernels() {
+	static const kernelTable table;
+	return table;
+}
+
+void convolveRow(const double* in, const DemandKernel& kernel, double* out, int length) {
+
+	const kernelTable& table = selectedKernels();
+	int width = kernel.maxDemand - kernel.minDemand + 1;
+
+	if (kernel.uniform && width >= slidingMinWidth)
+		convolveRowSliding(in, kernel, out, length);
+	else if (width <= CONV_UNROLLED_WIDTH)
+		table.byWidth[width](in, kernel, out, length);
+	else if (width < fftMinWidth)
+		table.wide(in, kernel, out, length);
+	else
+		convolveRowFft(in, kernel, out, length);
+}
+
+const char* convolutionIsa() {
+	selectedKernels();
+	return selectedIsa;
+}
+
+int convolutionFftWidth() {
+	selectedKernels();
+	return fftMinWidth;
+}
+
+/* Tempo médio, em ns, de uma convolução circular de "fn" sobre linhas de "length" posições.
+A linha é circular, como as da carga residual, para que a massa não saia dela e as
+probabilidades não se tornem subnormais ao longo das repetições. */
+static double timeRow(convolveRowFn fn, const DemandKernel& kernel, int length, int reps, double& sink) {
+
+	DemandRows rows;
+	rows.resize(2, length, (kernel.maxDemand + 7) / 8 * 8);
+	rows.row(0)[0] = 1;
+	wrapRow(rows.row(0), length, kernel.maxDemand);
+
+	auto begin = chrono::steady_clock::now();
+	for (int it = 0; it < reps; it++) {
+		fn(rows.row(it % 2), kernel, rows.row((it + 1) % 2), length);
+		wrapRow(rows.row((it + 1) % 2), length, kernel.maxDemand);
+	}
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+	sink += rows.row(0)[length / 2];
+
+	return 1e9 * elapsed / reps;
+}
+
+/*
+benchmarkConvolution: Compara a vazão por linha do laço original de probTotalDemand
+(linhas em vetores separados e teste de probabilidade positiva) com os kernels sobre o
+buffer contíguo, incluindo a soma deslizante, para alguns comprimentos de linha. Em
+seguida, para demandas não uniformes com suportes de largura crescente, compara o kernel
+direto selecionado com a FFT em blocos e indica a largura a partir da qual a FFT é mais
+rápida, para calibrar convolutionFftWidth.
+*/
+void benchmarkConvolution() {
+
+	const double presence = 0.6;
+	vector<double> probDemand(21, 0), weights(21, 0);
+	for (int k = 5; k <= 15; k++) {
+		probDemand[k] = 1.0 / 11.0;
+		weights[k] = presence * probDemand[k];
+	}
+
+	DemandKernel kernel;
+	kernel.absent = 1 - presence;
+	kernel.weights = weights.data();
+	kernel.minDemand = 5;
+	kernel.maxDemand = 15;
+	kernel.uniform = true;
+	kernel.uniformWeight = weights[5];
+
+	// Kernels diretos de largura 11, a do suporte [5,15]
+	vector<pair<const char*, convolveRowFn>> kernels;
+	kernels.push_back(make_pair("sliding", convolveRowSliding));
+	kernels.push_back(make_pair("scalar", convolveRowScalar<11>));
+#ifdef CONV_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		kernels.push_back(make_pair("avx2", convolveRowAvx2<11>));
+	if (__builtin_cpu_supports("avx512f"))
+		kernels.push_back(make_pair("avx512", convolveRowAvx512<11>));
+#endif
+
+	int lengths[] = { 64, 256, 1024, 4096 };
+	double sink = 0;
+
+	const char* isa = convolutionIsa();
+	cout << "Kernel selecionado: " << isa << " (soma deslizante para suportes uniformes com largura >= " << slidingMinWidth
+		<< ", FFT para suportes nao uniformes com largura >= " << fftMinWidth << ")" << endl;
+	cout << "Demanda uniforme em [5,15]" << endl;
+	cout << "comprimento  kernel     ns/linha    Mestados/s" << endl;
+
+	for (int length : lengths) {
+
+		int maxDemand = probDemand.size() - 1;
+		int reps = max(200, 20000000 / (length * maxDemand));
+
+		// Laço original: vector<vector<double>> e teste probDemandK > 0
+		vector<vector<double>> f(2, vector<double>(length, 0));
+		f[0][0] = 1;
+		auto begin = chrono::steady_clock::now();
+		for (int it = 0; it < reps; it++) {
+			vector<double>& prev = f[it % 2];
+			vector<double>& next = f[(it + 1) % 2];
+			for (int dem = 0; dem < length; dem++) {
+				next[dem] = (1 - presence) * prev[dem];
+				for (int k = 1; k <= min(maxDemand, dem); k++) {
+					double probDemandK = presence * probDemand[k];
+					if (probDemandK > 0)
+						next[dem] += probDemandK * prev[dem - k];
+				}
+			}
+		}
+		double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		sink += f[0][length / 2];
+		printf("%11d  %-9s %11.1f %13.1f\n", length, "original", 1e9 * elapsed / reps, 1e-6 * reps * (double)length / elapsed);
+
+		for (unsigned int i = 0; i < kernels.size(); i++) {
+			double ns = timeRow(kernels[i].second, kernel, length, reps, sink);
+			printf("%11d  %-9s %11.1f %13.1f\n", length, kernels[i].first, ns, 1e3 * length / ns);
+		}
+	}
+
+	// Demanda triangular em [1,W]: kernel direto (especializado ou genérico) contra FFT
+	const kernelTable& table = selectedKernels();
+	int widths[] = { 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512 };
+	int wideLengths[] = { 1024, 8192 };
+
+	cout << "\nDemanda triangular em [1,W]: kernel direto x FFT em blocos" << endl;
+	cout << "comprimento  largura   direto ns/linha   FFT ns/linha   razao" << endl;
+
+	for (int length : wideLengths) {
+
+		int crossover = 0;
+
+		for (int width : widths) {
+
+			if (width > length / 2)
+				break;
+
+			weights.assign(width + 1, 0);
+			for (int k = 1; k <= width; k++)
+				weights[k] = presence * (min(k, width + 1 - k)) / ((width + 1) / 2 * ((width + 2) / 2));
+
+			DemandKernel wide;
+			wide.absent = 1 - presence;
+			wide.weights = weights.data();
+			wide.minDemand = 1;
+			wide.maxDemand = width;
+			wide.uniform = false;
+
+			convolveRowFn direct = (width <= CONV_UNROLLED_WIDTH) ? table.byWidth[width] : table.wide;
+			int reps = max(50, 100000000 / (length * width));
+
+			double directNs = timeRow(direct, wide, length, reps, sink);
+			double fftNs = timeRow(convolveRowFft, wide, length, reps, sink);
+
+			if (fftNs < directNs && crossover == 0)
+				crossover = width;
+			else if (fftNs >= directNs)
+				crossover = 0;
+
+			printf("%11d  %7d  %16.1f  %13.1f  %6.2f\n", length, width, directNs, fftNs, directNs / fftNs);
+		}
+
+		if (crossover > 0)
+			printf("Comprimento %d: FFT mais rapida a partir de largura %d\n", length, crossover);
+		else
+			printf("Comprimento %d: FFT nao superou o kernel direto\n", length);
+	}
+
+	if (sink < 0)
+		cout << sink << endl;
+}
@@ -13,7 +13,7 @@ n: número de vértices do grafo.
 */
 void Graph::createInstance(int n) {
 
-    int range;
+    int range, lo, hi;
     vertex newVertex;
     //std::mt19937 generator(time(0)); // Para instâncias aleatórias
     std::mt19937 generator(7); // Para instâncias fixas
@@ -28,22 +28,24 @@ void Graph::createInstance(int n) {
     uniform_int_distribution<int> demand1(1, 9), demand2(5, 15), demand3(10, 20);
 
     this->numberVertices = n;
-    this->totalExpectedDemand = 0;
-    this->expectedDemand.resize(n);
-    fill(this->expectedDemand.begin(), this->expectedDemand.end(), 0);
+    this->vertices.clear();
 
     // Inicializar matriz de adjacências
     vector<double> v(n, 0);
     vector<vector<double>> matrix(n, v);
     this->adjMatrix = matrix;
-    this->maxDemand = 0;
 
     for (int i = 0; i < this->numberVertices; i++) {
 
         // Gerar coordenadas dos vértices em [0,100]
         newVertex.x = coordinate(generator);
         newVertex.y = coordinate(generator);
-        newVertex.probDemand[0] = 0;
+
+        // Depósito não possui demanda
+        if (i == 0) {
+            newVertex.probDemand.assign(1, 0);
+            newVertex.uniformDemand = false;
+        }
 
         if (i > 0) {
 
@@ -52,85 +54,87 @@ void Graph::createInstance(int n) {
             newVertex.probOfPresence = presence(generator);
             range = demRange(generator);
 
-            switch (range) {
-
-                // Intervalo [1,9]
-            case 1:
-
-                for (int j = 1; j < 21; j++) {
-
-                    if (j < 10) {
-                        newVertex.probDemand[j] = 1.0 / 9.0;
-                    }
-                    else {
-                        newVertex.probDemand[j] = 0;
-                    }
-
-                    this->expectedDemand[i] += newVertex.probDemand[j] * j;
-
-                }
-                this->maxDemand += 9;
-
-                break;
-
-                // Intervalo [5,15]
-            case 2:
+            // Intervalos [1,9], [5,15] e [10,20]
+            lo = (range == 1) ? 1 : (range == 2) ? 5 : 10;
+            hi = (range == 1) ? 9 : (range == 2) ? 15 : 20;
 
-                for (int j = 1; j < 21; j++) {
+            newVertex.probDemand.assign(hi + 1, 0);
+            for (int j = lo; j <= hi; j++)
+                newVertex.probDemand[j] = 1.0 / (hi - lo + 1);
 
-                    if (j >= 5 && j <= 15) {
-                        newVertex.probDemand[j] = 1.0 / 11.0;
-                    }
-                    else {
-                        newVertex.probDemand[j] = 0;
-                    }
+            newVertex.uniformDemand = true;
 
-                    this->expectedDemand[i] += newVertex.probDemand[j] * j;
-
-                }
-                this->maxDemand += 15;
+        }
 
-                break;
+        this->vertices.push_back(newVertex);
+    }
 
-                // Intervalo [10,20]
-            case 3:
+    computeDistances();
+    computeDemandTables();
 
-                for (int j = 1; j < 21; j++) {
+}
 
-                    if (j > 9) {
-                        newVertex.probDemand[j] = 1.0 / 11.0;
-                    }
-                    else {
-                        newVertex.probDemand[j] = 0;
-                    }
+/*
+computeDemandTables: Monta a distribuição da demanda de cada vértice (vertex::demand), com
+qualquer suporte inteiro positivo, a partir da presença e das probabilidades das demandas.
+As distribuições vão até a maior demanda com probabilidade positiva entre os clientes
+(demandLimit), e as somas usadas pelas avaliações das rotas (cauda, média, variância) são
+feitas uma única vez aqui. Calcula também a demanda esperada total e a soma das demandas
+máximas dos clientes.
+Como os custos das rotas dependem das demandas, a instância recebe um novo identificador
+(renewInstanceId).
+*/
+void Graph::computeDemandTables() {
 
-                    this->expectedDemand[i] += newVertex.probDemand[j] * j;
+    renewInstanceId();
 
-                }
-                this->maxDemand += 20;
+    this->demandLimit = 0;
+    this->maxDemand = 0;
+    this->totalExpectedDemand = 0;
 
+    for (int i = 1; i < this->numberVertices; i++) {
+        const vector<double>& p = this->vertices[i].probDemand;
+        for (int k = (int)p.size() - 1; k > this->demandLimit; k--) {
+            if (p[k] > 0) {
+                this->demandLimit = k;
                 break;
+            }
+        }
+    }
 
-            default:
-                break;
+    for (int i = 0; i < this->numberVertices; i++) {
 
-            }
+        vertex& v = this->vertices[i];
 
-            this->expectedDemand[i] *= newVertex.probOfPresence;
-            this->totalExpectedDemand += this->expectedDemand[i];
+        v.probDemand.resize(this->demandLimit + 1, 0);
+        v.demand.build(v.probOfPresence, v.probDemand, v.uniformDemand, this->demandLimit);
 
+        if (i > 0) {
+            this->totalExpectedDemand += v.demand.mean;
+            this->maxDemand += v.demand.maxDemand;
         }
-
-        this->vertices.push_back(newVertex);
     }
 
-    computeDistances();
+}
 
+/*
+renewInstanceId: Dá à instância um novo identificador, que distingue no cache de custos
+de rotas (RouteCostCache) os custos calculados antes. O contador é atômico, então
+instâncias criadas ao mesmo tempo em threads diferentes recebem identificadores
+distintos. Deve ser chamada sempre que demandas ou distâncias mudarem depois de
+computeDemandTables, inclusive ao preencher adjMatrix diretamente; senão, as
+avaliações leriam custos da instância anterior.
+*/
+void Graph::renewInstanceId() {
+
+    static atomic<int> instanceCounter(0);
+    this->instanceId = ++instanceCounter;
 }
 
 /*
 computeDistances: Computa as distâncias euclidianas de todos para todos os vértices,
-utilizando suas coordenadas.
+utilizando suas coordenadas. Como os custos das rotas mudam, a instância recebe um novo
+identificador (renewInstanceId).
 */
 void Graph::computeDistances() {
 
@@ -153,6 +157,27 @@ void Graph::computeDistances() {
         }
     }
 
+    this->symmetricDistances = true;
+    renewInstanceId();
+
+}
+
+/*
+checkSymmetry: Verifica se adjMatrix é simétrica e guarda o resultado em
+symmetricDistances. computeDistances já a mantém; quem preencher adjMatrix de outra
+forma deve chamá-la antes de usar avaliações que dependem da simetria, como
+routeExpectedLengthBothWays, e chamar também renewInstanceId.
+*/
+bool Graph::checkSymmetry() {
+
+    this->symmetricDistances = true;
+
+    for (int i = 0; i < this->numberVertices; i++)
+        for (int j = 0; j < i; j++)
+            if (this->adjMatrix[i][j] != this->adjMatrix[j][i])
+                this->symmetricDistances = false;
+
+    return this->symmetricDistances;
 }
 
 /*
@@ -172,7 +197,7 @@ void Graph::printInstance() {
         cout << "Prob. of presence: " << this->vertices[i].probOfPresence << endl;
         cout << "Demand probabilities: ";
 
-        for (int j = 1; j < 21; j++) {
+        for (int j = 1; j <= this->vertices[i].demand.maxDemand; j++) {
             cout << vertices[i].probDemand[j] << ' ';
         }
 
@@ -226,7 +251,7 @@ vector<int> Graph::TSP() {
     } while (next_permutation(vtxRouteOrder.begin(), vtxRouteOrder.end()));
 
     cout << "Smallest TSP route: ";
-    for (int i = 0; i < minPath.size(); i++)
+    for (unsigned int i = 0; i < minPath.size(); i++)
         cout << minPath[i] << ' ';
     cout << endl;
 
@@ -279,7 +304,7 @@ void Graph::drawGraph(string graphName) {
       }
 
       cout << "Create " << graphName << endl;
-      /*
+
       graphToEps(g, graphName).
         coords(coords).
         title("Figura do grafo").
@@ -213,7 +213,7 @@ void KMeans::run(vector<Point>& all_points){
 
 }
 
-int kmeans_main(Graph g, int numberVehicles){
+int kmeans_main(const Graph& g, int numberVehicles){
 
     //Fetching number of clusters
     int K = numberVehicles;
@@ -9,6 +9,10 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include "LShapedSVRP.h"
+#include "MonteCarloSVRP.h"
+#include "CheckSVRP.h"
+#include "SweepSVRP.h"
+#include "MultiStartSVRP.h"
 
 char verbosity;
 
@@ -24,6 +28,125 @@ int main(int argc, const char** argv) {
 
     srand(time(0));
 
+    /* Opções da busca tabu, aceitas em qualquer posição e retiradas dos argumentos antes
+    da escolha do modo, valendo para a execução única e para --multi-start:
+    --finalists N: candidatos avaliados exatamente após a triagem pela aproximação normal
+    --orient: mantém cada rota alterada no sentido mais barato (orientRoutes)
+    --threads N: threads que avaliam os candidatos de cada iteração (0 = número de núcleos) */
+    int numFinalists = 0, candidateThreads = 1;
+    bool orientRoutes = false;
+    vector<const char*> args(1, argv[0]);
+
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+
+        if (option == "--finalists" && i + 1 < argc) {
+            numFinalists = atoi(argv[++i]);
+            if (numFinalists < 0) {
+                printf("ERROR: --finalists must be non-negative.\n");
+                return 1;
+            }
+        }
+
+        else if (option == "--orient")
+            orientRoutes = true;
+
+        else if (option == "--threads" && i + 1 < argc) {
+            candidateThreads = atoi(argv[++i]);
+            if (candidateThreads < 0) {
+                printf("ERROR: --threads must be non-negative.\n");
+                return 1;
+            }
+        }
+
+        else
+            args.push_back(argv[i]);
+    }
+
+    argc = args.size();
+    argv = args.data();
+
+    // Microbenchmark do kernel de convolução das distribuições de demanda
+    if (argc == 2 && string(argv[1]) == "--bench-convolution") {
+        benchmarkConvolution();
+        return 0;
+    }
+
+    // Comparação das implementações do custo esperado em rotas aleatórias
+    if (argc >= 2 && string(argv[1]) == "--check") {
+        int numTrials = (argc >= 3) ? atoi(argv[2]) : 200;
+        return checkExpectedLength(numTrials, 1) == 0 ? 0 : 1;
+    }
+
+    // Varredura de capacidades: mesma instância e frota resolvidas para cada capacidade
+    if (argc >= 5 && string(argv[1]) == "--capacity-sweep") {
+        numberVertices = atoi(argv[2]);
+        numberVehicles = atoi(argv[3]);
+
+        if (numberVertices <= 1 || numberVehicles < 1 || numberVehicles > numberVertices - 1) {
+            printf("ERROR: Usage: --capacity-sweep <vertices> <vehicles> <capacity>...\n");
+            return 1;
+        }
+
+        vector<int> capacities;
+        for (int i = 4; i < argc; i++)
+            capacities.push_back(atoi(argv[i]));
+
+        verbosity = 'n';
+        graph.createInstance(numberVertices);
+        printSweep(graph, capacitySweep(graph, numberVehicles, capacities));
+        return 0;
+    }
+
+    // Varredura de frotas: mesma instância e capacidade resolvidas para cada número de veículos
+    if (argc == 6 && string(argv[1]) == "--fleet-sweep") {
+        numberVertices = atoi(argv[2]);
+        capacity = atoi(argv[3]);
+        int minVehicles = atoi(argv[4]), maxVehicles = atoi(argv[5]);
+
+        if (numberVertices <= 1 || minVehicles < 1 || minVehicles > maxVehicles || maxVehicles > numberVertices - 1) {
+            printf("ERROR: Usage: --fleet-sweep <vertices> <capacity> <min vehicles> <max vehicles>\n");
+            return 1;
+        }
+
+        verbosity = 'n';
+        graph.createInstance(numberVertices);
+        printSweep(graph, fleetSweep(graph, capacity, minVehicles, maxVehicles));
+        return 0;
+    }
+
+    /* Buscas tabu independentes em paralelo, reprodutíveis pela semente mestre, ou a
+    comparação entre elas e buscas cooperativas */
+    if ((argc == 6 || argc == 7) && (string(argv[1]) == "--multi-start" || string(argv[1]) == "--bench-cooperation")) {
+        numberVertices = atoi(argv[2]);
+        numberVehicles = atoi(argv[3]);
+        fillingCoeff = atof(argv[4]);
+
+        MultiStartOptions options;
+        options.numStarts = atoi(argv[5]);
+        options.numFinalists = numFinalists;
+        options.orientRoutes = orientRoutes;
+        options.candidateThreads = candidateThreads;
+        if (argc == 7)
+            options.masterSeed = strtoul(argv[6], NULL, 10);
+
+        if (numberVertices <= 1 || numberVehicles < 1 || numberVehicles > numberVertices - 1
+            || fillingCoeff <= 0 || fillingCoeff > 1 || options.numStarts < 1) {
+            printf("ERROR: Usage: %s <vertices> <vehicles> <filling coeff> <starts> [master seed] [--finalists N] [--orient] [--threads N]\n", argv[1]);
+            return 1;
+        }
+
+        verbosity = 'n';
+        graph.createInstance(numberVertices);
+        capacity = max(int(10.0 * ((double)numberVertices - 1.0) / (2.0 * (double)numberVehicles * fillingCoeff)), max(20, graph.demandLimit));
+
+        if (string(argv[1]) == "--bench-cooperation")
+            benchmarkCooperation(graph, numberVehicles, capacity, options);
+        else
+            printMultiStart(multiStartTabuSearch(graph, numberVehicles, capacity, options));
+        return 0;
+    }
+
     if (argc == 2) {
         instanceFile.open(argv[1], std::ios::in | std::ios::binary);
 
@@ -83,19 +206,23 @@ int main(int argc, const char** argv) {
 
     }
 
-    /* Capacidade regulada de acordo com os dados do problema */
-    capacity = max(int(10.0 * ((double)numberVertices - 1.0) / (2.0 * (double)numberVehicles * fillingCoeff)), 20);
+    /* Criar um grafo completo respeitando a desigualdade triangular */
+    graph.createInstance(numberVertices);
+
+    /* Capacidade regulada de acordo com os dados do problema, ao menos 20 e a maior demanda de um cliente */
+    capacity = max(int(10.0 * ((double)numberVertices - 1.0) / (2.0 * (double)numberVehicles * fillingCoeff)), max(20, graph.demandLimit));
 
     if (verbosity == 'y')
         cout << "Capacity of each vehicle: " << capacity << endl;
 
-    /* Criar um grafo completo respeitando a desigualdade triangular */
-    graph.createInstance(numberVertices);
-
     if (verbosity == 'y')
         graph.printInstance();
 
     TabuSearchSVRP ts;
+    ts.seed = time(0);
+    ts.numFinalists = numFinalists;
+    ts.orientRoutes = orientRoutes;
+    ts.numThreads = candidateThreads;
 
     clock_t begin = clock();
 
@@ -105,6 +232,33 @@ int main(int argc, const char** argv) {
 
     double elapsed_secs = ((double)end - (double)begin) / CLOCKS_PER_SEC;
 
+    if (verbosity == 'y') {
+        RouteCostCacheStats cacheStats = routeCostCache().stats();
+        cout << "Rotas avaliadas: " << ts.searchEvaluations << ", alocacoes na busca: " << ts.searchAllocations << endl;
+        cout << "Cache de rotas: " << cacheStats.hits << " acertos, " << cacheStats.misses << " falhas, "
+            << cacheStats.evictions << " descartes" << endl;
+
+        if (ts.lowerBounds)
+            cout << "Limitantes: " << ts.skippedEvaluations << " de " << ts.boundedCandidates << " avaliacoes de candidatos interrompidas" << endl;
+
+        if (ts.orientRoutes)
+            cout << "Rotas invertidas: " << ts.reversedRoutes << endl;
+
+        if (ts.numFinalists > 0)
+            cout << "Triagem: " << ts.exactCandidates << " de " << ts.screenedCandidates << " candidatos avaliados exatamente, erro relativo maximo "
+                << ts.maxScreeningError << ", medio " << ts.sumScreeningError / max(1LL, ts.exactCandidates) << endl;
+
+        // Verificação do custo analítico da melhor solução por simulação
+        if (bestSol.routes.size() != 0) {
+            MonteCarloOptions options;
+            options.antithetic = true;
+            options.controlVariate = true;
+            MonteCarloEstimate estimate = monteCarloExpectedLength(graph, capacity, bestSol.routes, options);
+            cout << "Monte Carlo: " << estimate.mean << " +- " << estimate.halfWidth << " (" << estimate.samples
+                << " cenarios), analitico: " << totalExpectedLength(graph, capacity, bestSol.routes) << endl;
+        }
+    }
+
     string nameOutputFile = "output/";
     nameOutputFile += "BestSolN" + to_string(numberVertices)
         + "M" + to_string(numberVehicles)
@@ -181,10 +335,12 @@ int main(int argc, const char** argv) {
 
     }
 
-    double L = 0.0;
     vector<int> allClients(numberVertices - 1); // -1, pois não pegamos o depósito
     iota(allClients.begin(), allClients.end(), 1); // Com 0 pegamos o depósito
-    vector<vector<double>> f = probTotalDemand(graph, allClients);
+    DemandRows f;
+    FailureProfile profile;
+    probTotalDemand(graph, allClients, f);
+    failureProfile(graph, f, capacity, allClients, profile);
 
     /*
     cout << "f: ";
@@ -193,21 +349,7 @@ int main(int argc, const char** argv) {
         cout << f[f.size() - 1][i] << " ";
     }
     cout << endl;*/
-    //cout << "Closest Clients: ";
-    for (unsigned int i = 0; i < numberVehicles; i++) {
-        //cout << ts.closestNeighbours[0][i] << " ";
-        //double P = probExceedsCapacity(numberVertices - 2, graph, f, numberVehicles * capacity, allClients, i + 1);
-        double P = 0.0;
-        for (unsigned int j = (numberVehicles + i) * capacity + 1; j <= 20 * (numberVertices - 1); j++) {
-            P += f[numberVertices-1][j];
-        }
-        //cout << "P: " << P << endl;
-        if (i < ts.closestNeighbours[0].size())
-            L += P * graph.adjMatrix[0][ts.closestNeighbours[0][i]];
-    }
-    //cout << endl;
-    
-    L *= 2.0;
+    double L = restockLowerBound(graph, profile, numberVehicles, ts.closestNeighbours[0]);
     //cout << "L: " << L << endl;
 
     solveSVRP(graph, numberVehicles, capacity, L);